@@ -1,13 +1,28 @@
 import { getJSON } from "./http.js";
 
 export const fsInfo = () => getJSON("/fs/info");
-export const fsList = (path = "/") =>
-  getJSON(`/fs/list?path=${encodeURIComponent(path)}`);
+// /fs/list is gepagineerd: volg next_cursor (naam van de laatste entry) tot
+// de hele map binnen is. 409 = cursor-entry intussen verwijderd: opnieuw.
+export async function fsList(path = "/", limit = 200){
+  let entries = [], cursor = null, page;
+  do {
+    const c = cursor == null ? "" : `&cursor=${encodeURIComponent(cursor)}`;
+    page = await getJSON(`/fs/list?path=${encodeURIComponent(path)}&limit=${limit}${c}`);
+    entries = entries.concat(page.entries || []);
+    cursor = page.next_cursor;
+  } while (cursor != null);
+  return { ...page, entries };
+}
 
 export function fsDownloadUrl(path){
   return `/fs/download?path=${encodeURIComponent(path)}`;
 }
 
+// Hele map als .tar (gestreamd door het apparaat).
+export function fsArchiveUrl(path = "/"){
+  return `/fs/archive?path=${encodeURIComponent(path)}`;
+}
+
 export async function fsUpload(dir, file, overwrite = false){
   const fd = new FormData();
   fd.append("path", dir || "/");
@@ -18,6 +33,18 @@ export async function fsUpload(dir, file, overwrite = false){
   return r.headers.get("content-type")?.includes("json") ? r.json() : r.text();
 }
 
+// Tar-bundel (Blob/ArrayBuffer) in één request uitpakken; alles of niets.
+export async function fsUnpack(dir, tar, overwrite = false){
+  const q = `path=${encodeURIComponent(dir || "/")}&overwrite=${overwrite ? 1 : 0}`;
+  const r = await fetch(`/fs/unpack?${q}`, {
+    method: "POST",
+    headers: { "Content-Type": "application/x-tar" },
+    body: tar
+  });
+  if (!r.ok) throw new Error(`Unpack failed (${r.status})`);
+  return r.json();
+}
+
 export async function fsRename(from, to){
   const body = new URLSearchParams({ from, to }).toString();
   const r = await fetch("/fs/rename", {
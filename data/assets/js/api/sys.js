@@ -4,3 +4,9 @@ export const getInfo    = () => getJSON("/info", 4000);
 export const ping       = () => getJSON("/health", 3000);
 export const sysInfo    = () => getJSON("/sys/info", 4000);
 export const sysActive  = () => getJSON("/sys/active", 4000);
+// Meerdere resources in één request, bv. batch("info,health,sys,active")
+export const batch      = (names) => getJSON(`/batch?r=${encodeURIComponent(names)}`, 4000);
+// SSE-stream met gecombineerde telemetrie (info + sys + active + sensoren)
+export const EVENTS_URL = "/events";
+export const sysHistory = (metric, tier = "1s") =>
+  getJSON(`/sys/history?metric=${encodeURIComponent(metric)}&tier=${encodeURIComponent(tier)}`, 4000);
@@ -1,2 +1,2 @@
-export const AUTO_REFRESH_MS = 3000;   // interval voor info/health/system
+export const AUTO_REFRESH_MS = 3000;   // interval voor info/health/system (polling en /events)
 export const RSSI_HISTORY_MAX = 120;   // ~60 punten zichtbaar in sparkline
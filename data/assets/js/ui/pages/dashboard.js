@@ -73,30 +73,98 @@ export function initDashboard(){
     drawSparkline(el.sparkLine, store.rssiHistory());
   }
 
-  async function updateInfo(){
+  // RSSI-historie van het device (overleeft een page reload); één punt per refresh-interval.
+  async function seedRssiHistory(){
     try{
-      const info = await sys.getInfo();
-      const { ip, ssid, rssi, mode } = info;
-
-      setText(el.ip, ip || "–");
-      setText(el.ssid, ssid || "–");
-      setText(el.rssiDbm, (typeof rssi === "number" ? rssi : "–"));
-
-      if (el.modeTag){
-        if (mode){ setText(el.modeTag, mode); el.modeTag.classList.remove("hidden"); }
-        else { el.modeTag.classList.add("hidden"); }
-      }
-
-      if (typeof rssi === "number"){
-        applySignalQuality(el.rssiBar, el.rssiQ, rssi);
-        store.pushRssi(rssi);
-      } else {
-        applySignalQuality(el.rssiBar, el.rssiQ, undefined);
-        store.clearRssi();
-      }
-
+      const h = await sys.sysHistory("rssi", "1s");
+      const every = Math.max(1, Math.round(AUTO_REFRESH_MS / 1000 / (h.step_s || 1)));
+      const d = h.d || [];
+      let acc = 0;
+      d.forEach((delta, i) => {
+        if (delta === null) return;
+        acc += delta;
+        if ((d.length - 1 - i) % every === 0) store.pushRssi(acc);
+      });
       updateSparkMeta();
-      setText(el.lastUpdated, `Last update: ${fmtTime()}`);
+    }catch(e){
+      console.warn("[app] /sys/history failed:", e?.message || e);
+    }
+  }
+
+  function renderInfo(info){
+    const { ip, ssid, rssi, mode } = info;
+
+    setText(el.ip, ip || "–");
+    setText(el.ssid, ssid || "–");
+    setText(el.rssiDbm, (typeof rssi === "number" ? rssi : "–"));
+
+    if (el.modeTag){
+      if (mode){ setText(el.modeTag, mode); el.modeTag.classList.remove("hidden"); }
+      else { el.modeTag.classList.add("hidden"); }
+    }
+
+    if (typeof rssi === "number"){
+      applySignalQuality(el.rssiBar, el.rssiQ, rssi);
+      store.pushRssi(rssi);
+    } else {
+      applySignalQuality(el.rssiBar, el.rssiQ, undefined);
+      store.clearRssi();
+    }
+
+    updateSparkMeta();
+    setText(el.lastUpdated, `Last update: ${fmtTime()}`);
+  }
+
+  function renderHealth(ok, latency){
+    setDot(el.dot, ok);
+    setText(el.healthText, ok ? "OK" : "Unavailable");
+    setText(el.latency, latency);
+    setText(el.lastCheck, fmtTime());
+  }
+
+  function renderSys(info){
+    setText(el.sysUptime, fmtSec(info.uptime_s));
+    setText(el.sysHeap,   fmtBytes(info.heap_free));
+
+    // null = geen meting (run-time stats uit in de firmware, of opwarmen)
+    const raw0 = info.cpu_load?.[0], raw1 = info.cpu_load?.[1];
+    const c0 = Number(raw0 ?? 0);
+    const c1 = Number(raw1 ?? 0);
+    setText(el.cpu0, raw0 == null ? "n/a" : c0.toFixed(1));
+    setText(el.cpu1, raw1 == null ? "n/a" : c1.toFixed(1));
+    setWidth(el.cpu0bar, `${Math.min(100, Math.max(0, c0))}%`);
+    setWidth(el.cpu1bar, `${Math.min(100, Math.max(0, c1))}%`);
+  }
+
+  function renderActive(act){
+    if (!el.taskTbody) return;
+    if (!act.tasks || !act.tasks.length){
+      el.taskTbody.innerHTML = `<tr><td colspan="5" class="muted">No data</td></tr>`;
+      return;
+    }
+    el.taskTbody.innerHTML = act.tasks.map(t=>{
+      const core = t.core===0?'0': t.core===1?'1':'?';
+      return `<tr>
+        <td class="mono">${t.name}</td>
+        <td class="mono center">${core}</td>
+        <td class="mono right">${t.prio}</td>
+        <td class="mono right">${t.stack_min}</td>
+        <td class="mono right">${t.share.toFixed(2)}</td>
+      </tr>`;
+    }).join("");
+  }
+
+  // Eén /events frame: zelfde velden als /info, /sys/info en /sys/active.
+  function applyFrame(f){
+    if (f.info) renderInfo(f.info);
+    renderHealth(true, "live");
+    if (f.sys) renderSys(f.sys);
+    if (f.active) renderActive(f.active);
+  }
+
+  async function updateInfo(){
+    try{
+      renderInfo(await sys.getInfo());
     }catch(e){
       applySignalQuality(el.rssiBar, el.rssiQ, undefined);
       store.clearRssi();
@@ -109,65 +177,87 @@ export function initDashboard(){
   async function updateHealth(){
     try{
       const res = await sys.ping();
-      setDot(el.dot, true);
-      setText(el.healthText, "OK");
-      setText(el.latency, `${res._rt} ms`);
-      setText(el.lastCheck, fmtTime());
+      renderHealth(true, `${res._rt} ms`);
     }catch(e){
-      setDot(el.dot, false);
-      setText(el.healthText, "Unavailable");
-      setText(el.latency, "–");
-      setText(el.lastCheck, fmtTime());
+      renderHealth(false, "–");
       console.warn("[app] /health failed:", e?.message || e);
     }
   }
 
   async function refreshSystem(){
-    try{
-      const info = await sys.sysInfo();
-      setText(el.sysUptime, fmtSec(info.uptime_s));
-      setText(el.sysHeap,   fmtBytes(info.heap_free));
-
-      const c0 = Number(info.cpu_load?.[0] ?? 0);
-      const c1 = Number(info.cpu_load?.[1] ?? 0);
-      setText(el.cpu0, c0.toFixed(1));
-      setText(el.cpu1, c1.toFixed(1));
-      setWidth(el.cpu0bar, `${Math.min(100, Math.max(0, c0))}%`);
-      setWidth(el.cpu1bar, `${Math.min(100, Math.max(0, c1))}%`);
-    }catch{}
+    try{ renderSys(await sys.sysInfo()); }catch{}
+    try{ renderActive(await sys.sysActive()); }catch{}
+  }
 
+  // ------- auto loop -------
+  // Bij voorkeur één SSE-stream (/events); pollen alleen als die er niet is
+  // of stilvalt. EventSource herverbindt zelf bij korte onderbrekingen.
+  let timer = null, stream = null, stallTimer = null;
+
+  // Fallback: één /batch request per tick i.p.v. vier losse.
+  async function pollOnce(){
     try{
-      const act = await sys.sysActive();
-      if (!el.taskTbody) return;
-      if (!act.tasks || !act.tasks.length){
-        el.taskTbody.innerHTML = `<tr><td colspan="5" class="muted">No data</td></tr>`;
-        return;
-      }
-      el.taskTbody.innerHTML = act.tasks.map(t=>{
-        const core = t.core===0?'0': t.core===1?'1':'?';
-        return `<tr>
-          <td class="mono">${t.name}</td>
-          <td class="mono center">${core}</td>
-          <td class="mono right">${t.prio}</td>
-          <td class="mono right">${t.stack_min}</td>
-          <td class="mono right">${t.share.toFixed(2)}</td>
-        </tr>`;
-      }).join("");
-    }catch{}
+      const b = await sys.batch("info,health,sys,active");
+      renderInfo(b.info);
+      renderHealth(true, `${b._rt} ms`);
+      renderSys(b.sys);
+      renderActive(b.active);
+    }catch(e){
+      applySignalQuality(el.rssiBar, el.rssiQ, undefined);
+      store.clearRssi();
+      updateSparkMeta();
+      renderHealth(false, "–");
+      setText(el.lastUpdated, `Last update: ${fmtTime()} (error)`);
+      console.warn("[app] /batch failed:", e?.message || e);
+    }
   }
 
-  // ------- auto loop -------
-  let timer = null;
-  function startAuto(){
+  function startPolling(){
     if (timer) return;
-    updateInfo(); updateHealth(); refreshSystem();
-    timer = setInterval(()=>{ updateInfo(); updateHealth(); refreshSystem(); }, AUTO_REFRESH_MS);
+    pollOnce();
+    timer = setInterval(pollOnce, AUTO_REFRESH_MS);
   }
-  function stopAuto(){
+  function stopPolling(){
     if (!timer) return;
     clearInterval(timer); timer = null;
   }
 
+  function fallBack(reason){
+    console.warn(`[app] /events ${reason}, falling back to polling`);
+    stopStream();
+    startPolling();
+  }
+  function armStall(){
+    clearTimeout(stallTimer);
+    stallTimer = setTimeout(() => fallBack("stalled"), 3 * AUTO_REFRESH_MS);
+  }
+  function startStream(){
+    if (!("EventSource" in window)) return false;
+    stream = new EventSource(sys.EVENTS_URL);
+    stream.addEventListener("telemetry", (e) => {
+      try{ applyFrame(JSON.parse(e.data)); }
+      catch(err){ console.warn("[app] bad /events frame:", err?.message || err); return; }
+      armStall();
+    });
+    stream.onerror = () => { if (stream && stream.readyState === EventSource.CLOSED) fallBack("closed"); };
+    armStall();
+    return true;
+  }
+  function stopStream(){
+    clearTimeout(stallTimer); stallTimer = null;
+    if (!stream) return;
+    stream.close(); stream = null;
+  }
+
+  function startAuto(){
+    if (timer || stream) return;
+    if (!startStream()) startPolling();
+  }
+  function stopAuto(){
+    stopStream();
+    stopPolling();
+  }
+
   // ------- bindings -------
   on(el.btnPing, "click", (e)=>{ e.preventDefault(); updateHealth(); });
   on(el.autoRefresh, "change", (e)=> e.target.checked ? startAuto() : stopAuto());
@@ -178,5 +268,7 @@ export function initDashboard(){
   window.__sys  = refreshSystem;
 
   // go
-  if (!el.autoRefresh || el.autoRefresh.checked) startAuto();
+  seedRssiHistory().finally(() => {
+    if (!el.autoRefresh || el.autoRefresh.checked) startAuto();
+  });
 }
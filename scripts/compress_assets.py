@@ -0,0 +1,96 @@
+"""PlatformIO pre-script: bouwt een gestagede kopie van data/ met
+voorgecomprimeerde varianten en laat buildfs/uploadfs die map gebruiken.
+
+Per tekst-asset (.html .css .js .json .svg .txt .ico) komt er een .gz naast
+(gzip -9, mtime 0 => reproduceerbaar) als dat minstens 10% scheelt; optioneel
+ook .br (pip install brotli; browsers sturen 'br' alleen over HTTPS).
+De webserver kiest via Accept-Encoding (zie HttpUtils::sendFilePlain).
+
+platformio.ini:
+    extra_scripts = pre:scripts/compress_assets.py
+    custom_assets_brotli = no          ; yes = ook .br maken
+    custom_assets_keep_original = yes  ; no = alleen de gecomprimeerde variant
+"""
+import gzip
+import os
+
+Import("env")  # noqa: F821  (door PlatformIO geïnjecteerd)
+
+COMPRESSIBLE = (".html", ".css", ".js", ".json", ".svg", ".txt", ".ico")
+MIN_GAIN = 0.90   # gecomprimeerd moet < 90% van het origineel zijn
+
+
+def _opt(name, default):
+    val = env.GetProjectOption(name, default)  # noqa: F821
+    return str(val).strip().lower() in ("1", "yes", "true", "on")
+
+
+def _write_if_changed(path, data):
+    if os.path.exists(path):
+        with open(path, "rb") as f:
+            if f.read() == data:
+                return
+    with open(path, "wb") as f:
+        f.write(data)
+
+
+def stage(src_dir, dst_dir, use_brotli, keep_original):
+    brotli = None
+    if use_brotli:
+        try:
+            import brotli  # type: ignore
+        except ImportError:
+            print("[assets] brotli module ontbreekt; alleen gzip")
+
+    wanted = set()
+    saved_in = saved_out = 0
+    for root, _dirs, files in os.walk(src_dir):
+        rel_root = os.path.relpath(root, src_dir)
+        out_root = os.path.normpath(os.path.join(dst_dir, rel_root))
+        os.makedirs(out_root, exist_ok=True)
+        for name in files:
+            if name.endswith((".gz", ".br")):
+                continue
+            src = os.path.join(root, name)
+            with open(src, "rb") as f:
+                raw = f.read()
+
+            variants = {}
+            if name.lower().endswith(COMPRESSIBLE) and raw:
+                gz = gzip.compress(raw, compresslevel=9, mtime=0)
+                if len(gz) < len(raw) * MIN_GAIN:
+                    variants[".gz"] = gz
+                if brotli is not None:
+                    br = brotli.compress(raw, quality=11)
+                    if len(br) < len(raw) * MIN_GAIN:
+                        variants[".br"] = br
+
+            out = os.path.join(out_root, name)
+            if keep_original or not variants:
+                _write_if_changed(out, raw)
+                wanted.add(out)
+            for ext, data in variants.items():
+                _write_if_changed(out + ext, data)
+                wanted.add(out + ext)
+            if ".gz" in variants:
+                saved_in += len(raw)
+                saved_out += len(variants[".gz"])
+
+    # verwijderde bronbestanden ook uit de staging halen
+    for root, _dirs, files in os.walk(dst_dir):
+        for name in files:
+            path = os.path.join(root, name)
+            if path not in wanted:
+                os.remove(path)
+
+    if saved_in:
+        print("[assets] gzip: %d -> %d bytes (%.1fx)" % (saved_in, saved_out, saved_in / float(saved_out)))
+
+
+src_dir = env.subst("$PROJECT_DATA_DIR")  # noqa: F821
+dst_dir = os.path.join(env.subst("$PROJECT_BUILD_DIR"), env.subst("$PIOENV"), "data_staged")  # noqa: F821
+if os.path.isdir(src_dir):
+    stage(src_dir, dst_dir,
+          use_brotli=_opt("custom_assets_brotli", "no"),
+          keep_original=_opt("custom_assets_keep_original", "yes"))
+    env.Replace(PROJECT_DATA_DIR=dst_dir)  # noqa: F821
@@ -0,0 +1,143 @@
+"""PlatformIO script: pakt de UI-assets in een read-only image voor de
+"assets"-partitie (zie src/WebServer/AssetPack.h) en haalt ze uit het
+LittleFS-image, dat dan alleen nog veranderlijke data bevat.
+
+Na scripts/compress_assets.py draaien, zodat .gz/.br varianten meegaan:
+
+    [env:esp32dev_assets]
+    extends = env:esp32dev
+    board_build.partitions = partitions_assets.csv
+    extra_scripts = pre:scripts/compress_assets.py
+                    pre:scripts/pack_assets.py
+
+    pio run -e esp32dev_assets -t uploadassets   ; image flashen (USB)
+"""
+import csv
+import os
+import struct
+import time
+import zlib
+
+Import("env")  # noqa: F821  (door PlatformIO geïnjecteerd)
+
+PACKED = (".html", ".css", ".js", ".json", ".svg", ".png", ".jpg", ".jpeg", ".ico")
+VARIANT = {"": 1, ".gz": 2, ".br": 4}   # FileIndex::Variant
+HEADER = struct.Struct("<4sHHII")       # magic ver count built size
+ENTRY = struct.Struct("<IIIIIB3x")      # hash name_off data_off size crc variant
+
+
+def fnv1a(s):
+    h = 2166136261
+    for b in s.encode("utf-8"):
+        h = ((h ^ b) * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def split_variant(rel):
+    for suffix in (".gz", ".br"):
+        if rel.endswith(suffix):
+            return rel[: -len(suffix)], suffix
+    return rel, ""
+
+
+def collect(src_dir):
+    """{pad: bytes} van alle te packen bestanden + lijst van de rest."""
+    packed, rest = {}, []
+    for root, _dirs, files in os.walk(src_dir):
+        for name in files:
+            full = os.path.join(root, name)
+            rel = "/" + os.path.relpath(full, src_dir).replace(os.sep, "/")
+            logical, _ = split_variant(rel)
+            if logical.lower().endswith(PACKED):
+                with open(full, "rb") as f:
+                    packed[rel] = f.read()
+            else:
+                rest.append((full, rel))
+    return packed, rest
+
+
+def build_image(files):
+    # CRC (ETag) per logisch pad: van de plain bron, anders de eerste variant
+    crc = {}
+    for rel in sorted(files, key=lambda r: split_variant(r)[1]):
+        logical, _ = split_variant(rel)
+        crc.setdefault(logical, zlib.crc32(files[rel]) & 0xFFFFFFFF)
+
+    order = sorted(files, key=lambda r: (fnv1a(split_variant(r)[0]), r))
+    names = b""
+    name_off = {}
+    table_end = HEADER.size + ENTRY.size * len(order)
+    for rel in order:
+        name_off[rel] = table_end + len(names)
+        names += rel.encode("utf-8") + b"\0"
+    data_start = (table_end + len(names) + 3) & ~3
+
+    blob, entries = b"", b""
+    for rel in order:
+        logical, suffix = split_variant(rel)
+        data = files[rel]
+        entries += ENTRY.pack(fnv1a(logical), name_off[rel], data_start + len(blob),
+                              len(data), crc[logical], VARIANT[suffix])
+        blob += data + b"\0" * (-len(data) % 4)
+
+    size = data_start + len(blob)
+    header = HEADER.pack(b"TMAP", 1, len(order), int(time.time()), size)
+    pad = b"\0" * (data_start - table_end - len(names))
+    return header + entries + names + pad + blob
+
+
+def partition(csv_path, label):
+    with open(csv_path) as f:
+        for row in csv.reader(line for line in f if not line.lstrip().startswith("#")):
+            row = [c.strip() for c in row]
+            if row and row[0] == label:
+                return int(row[3], 0), int(row[4], 0)
+    return None, None
+
+
+src_dir = env.subst("$PROJECT_DATA_DIR")  # noqa: F821
+build_dir = os.path.join(env.subst("$PROJECT_BUILD_DIR"), env.subst("$PIOENV"))  # noqa: F821
+image_path = os.path.join(build_dir, "assets.bin")
+fs_dir = os.path.join(build_dir, "data_fs")
+
+if os.path.isdir(src_dir):
+    files, rest = collect(src_dir)
+    image = build_image(files)
+
+    table = os.path.join(env.subst("$PROJECT_DIR"), env.GetProjectOption("board_build.partitions", ""))  # noqa: F821
+    offset, capacity = partition(table, "assets") if os.path.isfile(table) else (None, None)
+    if capacity is not None and len(image) > capacity:
+        env.Exit("[assets] image %d bytes > partitie %d bytes" % (len(image), capacity))  # noqa: F821
+
+    os.makedirs(build_dir, exist_ok=True)
+    with open(image_path, "wb") as f:
+        f.write(image)
+    print("[assets] %d bestanden -> %s (%d bytes)" % (len(files), image_path, len(image)))
+
+    # LittleFS-image zonder de gepackte bestanden
+    wanted = set()
+    for full, rel in rest:
+        out = os.path.join(fs_dir, rel.lstrip("/"))
+        os.makedirs(os.path.dirname(out), exist_ok=True)
+        with open(full, "rb") as fi:
+            data = fi.read()
+        if not os.path.exists(out) or open(out, "rb").read() != data:
+            with open(out, "wb") as fo:
+                fo.write(data)
+        wanted.add(os.path.normpath(out))
+    os.makedirs(fs_dir, exist_ok=True)
+    for root, _dirs, names in os.walk(fs_dir):
+        for name in names:
+            path = os.path.normpath(os.path.join(root, name))
+            if path not in wanted:
+                os.remove(path)
+    env.Replace(PROJECT_DATA_DIR=fs_dir)  # noqa: F821
+
+    if offset is not None:
+        env.AddCustomTarget(  # noqa: F821
+            name="uploadassets",
+            dependencies=None,
+            actions=['"$PYTHONEXE" "$UPLOADER" --chip esp32 write_flash 0x%x "%s"' % (offset, image_path)],
+            title="Upload assets",
+            description="Flash assets.bin naar de assets-partitie (USB)",
+        )
@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+"""Symboliseer een /sys/profile dump tegen de firmware-ELF.
+
+Invoer (van het device):
+    # tm-profile 1 rate_hz=2000 samples=8000 dropped=0
+    <task>\t0x<pc>\t<core>\t<count>
+
+Uitvoer: "folded stacks" (task;functie count), direct bruikbaar met
+flamegraph.pl, speedscope of inferno. Een top-lijst gaat naar stderr.
+
+    curl -o profile.txt "http://<device>/sys/profile?ms=5000"
+    python scripts/profile_symbolize.py profile.txt .pio/build/esp32dev/firmware.elf > profile.folded
+"""
+import argparse
+import collections
+import glob
+import os
+import shutil
+import subprocess
+import sys
+
+
+def find_addr2line(explicit):
+    if explicit:
+        return explicit
+    for name in ("xtensa-esp32-elf-addr2line", "xtensa-esp-elf-addr2line"):
+        path = shutil.which(name)
+        if path:
+            return path
+    pio = os.path.expanduser("~/.platformio/packages")
+    for cand in sorted(glob.glob(os.path.join(pio, "toolchain-xtensa*", "bin", "*-addr2line*"))):
+        return cand
+    sys.exit("addr2line niet gevonden; geef --addr2line <pad> op")
+
+
+def parse(path):
+    header, rows = "", []
+    with open(path, encoding="utf-8", errors="replace") as f:
+        for line in f:
+            line = line.rstrip("\n")
+            if not line:
+                continue
+            if line.startswith("#"):
+                header = line
+                continue
+            task, pc, core, count = line.split("\t")
+            rows.append((task, int(pc, 16), int(core), int(count)))
+    return header, rows
+
+
+def symbolize(tool, elf, pcs, with_lines):
+    pcs = sorted({pc for pc in pcs if pc})
+    if not pcs:
+        return {}
+    out = subprocess.run([tool, "-e", elf, "-f", "-C"] + ["0x%08x" % pc for pc in pcs],
+                         check=True, capture_output=True, text=True).stdout.splitlines()
+    names = {}
+    for i, pc in enumerate(pcs):
+        func = out[2 * i].strip() if 2 * i < len(out) else "??"
+        loc = out[2 * i + 1].strip() if 2 * i + 1 < len(out) else "??:0"
+        if func == "??":
+            func = "0x%08x" % pc
+        if with_lines and not loc.startswith("??"):
+            func += " (%s)" % os.path.basename(loc.split(" ")[0])
+        names[pc] = func.replace(";", ":")
+    return names
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("profile", help="dump van /sys/profile")
+    ap.add_argument("elf", help="firmware.elf van dezelfde build")
+    ap.add_argument("--addr2line", help="pad naar xtensa addr2line")
+    ap.add_argument("--lines", action="store_true", help="bestand:regel aan de functienaam toevoegen")
+    ap.add_argument("--per-core", action="store_true", help="core als extra wortel-frame")
+    ap.add_argument("--top", type=int, default=20, help="aantal regels in de top-lijst (stderr)")
+    args = ap.parse_args()
+
+    header, rows = parse(args.profile)
+    names = symbolize(find_addr2line(args.addr2line), args.elf, [r[1] for r in rows], args.lines)
+
+    folded = collections.Counter()
+    per_func = collections.Counter()
+    for task, pc, core, count in rows:
+        func = names.get(pc, "(isr)" if not pc else "0x%08x" % pc)
+        root = "core%d;%s" % (core, task) if args.per_core else task
+        folded["%s;%s" % (root, func)] += count
+        per_func[func] += count
+
+    for stack, count in sorted(folded.items(), key=lambda kv: -kv[1]):
+        print("%s %d" % (stack, count))
+
+    total = sum(per_func.values()) or 1
+    print(header or "# tm-profile", file=sys.stderr)
+    for func, count in per_func.most_common(args.top):
+        print("%6.2f%%  %7d  %s" % (100.0 * count / total, count, func), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
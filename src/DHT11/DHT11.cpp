@@ -14,6 +14,7 @@ bool DHTSensor::read() {
   TempAndHumidity data = _dht.getTempAndHumidity();
   _status = _dht.getStatus();
   _statusText = _dht.getStatusString();   // hier mag het (niet-const context)
+  _reads++;
 
   if (_status == 0) {
     _temperature = data.temperature;
@@ -22,6 +23,7 @@ bool DHTSensor::read() {
     return true;
   }
 
+  _errors++;
   Serial.printf("[DHT] Read error: %s\n", _statusText.c_str());
   return false;
 }
@@ -12,6 +12,10 @@ public:
   int   status()      const { return _status; }
   String statusString() const { return _statusText; } // gebruikt cache
 
+  // Tellers sinds boot (voor /metrics)
+  uint32_t reads()  const { return _reads; }
+  uint32_t errors() const { return _errors; }
+
 private:
   DHTesp _dht;
   uint8_t _pin = 255;
@@ -20,6 +24,9 @@ private:
   float _humidity    = NAN;
   int   _status      = -1;
   String _statusText = String("uninitialized");
+
+  uint32_t _reads  = 0;
+  uint32_t _errors = 0;
 };
 
 // Global singleton (optioneel)
@@ -1,5 +1,6 @@
 #include "ErrorLogger.h"
 #include <WiFi.h>
+#include <TaskMonitor/Trace.h>
 
 // -------- RTC data (persist tussen resets) --------
 RTC_DATA_ATTR uint32_t   ErrorLogger::_rtcLastUptimeSec = 0;
@@ -121,7 +122,8 @@ void ErrorLogger::logHeapSnapshot(const char* label) {
   String line = String("[") + (label?label:"HEAP") + "] " + (tv?ts:"time=unsynced") +
                 " | free=" + String(free8) +
                 " | min="  + String(min8) +
-                " | largest=" + String(largest);
+                " | largest=" + String(largest) +
+                " | frag=" + String(free8 ? 100.f * (1.f - (float)largest / (float)free8) : 0.f, 1) + "%";
 
 #ifdef BOARD_HAS_PSRAM
   line += " | psram_free=" + String(ESP.getFreePsram());
@@ -171,6 +173,24 @@ void ErrorLogger::_logTaskWatermarks() {
 #endif
 }
 
+void ErrorLogger::logTaskWatermark(const char* name, uint32_t headroom, const char* note) {
+  bool tv=false; String ts=_nowIso8601(tv);
+  String line = String("[TASK] ") + (tv?ts:"time=unsynced") +
+                " | name=" + (name?name:"?") + " | hw=" + String(headroom);
+  if (note && *note) line += String(" | ") + note;
+  _appendLine(line);
+}
+
+void ErrorLogger::logTransfer(const char* path, uint32_t bytes, uint32_t ms, bool complete) {
+  bool tv=false; String ts=_nowIso8601(tv, 0);
+  const uint32_t kbps = ms ? (uint32_t)((uint64_t)bytes * 1000ULL / 1024ULL / ms) : 0;
+  String line = String("[XFER] ") + (tv?ts:"time=unsynced") +
+                " | path=" + (path?path:"?") + " | bytes=" + String(bytes) +
+                " | ms=" + String(ms) + " | kBps=" + String(kbps);
+  if (!complete) line += " | aborted";
+  _appendLine(line);
+}
+
 void ErrorLogger::_dumpBreadcrumbs() {
   // Dump ringbuffer in chronologische volgorde vanaf oudste item.
   const uint32_t N = sizeof(_bcRing)/sizeof(_bcRing[0]);
@@ -247,6 +267,7 @@ bool ErrorLogger::_ensureFS() {
 }
 
 void ErrorLogger::_appendLine(const String& line) {
+  TRACE_SCOPE("log.append");
   if (!_ensureFS()) return;
   File f = LittleFS.open(_path, "a");
   if (!f) return;
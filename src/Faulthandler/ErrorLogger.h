@@ -35,6 +35,13 @@ public:
   void logNetSnapshot(const char* label = "NET");
   void logHeapSnapshot(const char* label = "HEAP");
 
+  // [TASK]-regel voor een task met weinig stack-headroom (bytes).
+  void logTaskWatermark(const char* name, uint32_t headroom, const char* note = nullptr);
+
+  // [XFER]-regel per bestandsoverdracht: bytes, duur en doorvoer.
+  // Wacht niet op tijdsync; veilig vanuit de webserver-task.
+  void logTransfer(const char* path, uint32_t bytes, uint32_t ms, bool complete);
+
 private:
   // ---------- bestandsbeheer ----------
   bool _ensureFS();
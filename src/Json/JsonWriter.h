@@ -0,0 +1,128 @@
+#pragma once
+#include <Arduino.h>
+#include <type_traits>
+
+// Streaming JSON naar een willekeurige Print (response-stream, Serial, buffer)
+// zonder heap-allocaties: komma's en nesting (max 32 niveaus) worden
+// bijgehouden, string-waarden ge-escaped. Keys zijn constanten (F("..") of
+// literals) en gaan ongewijzigd naar buiten.
+//
+//   JsonWriter j(out);
+//   j.beginObject();
+//   j.field(F("uptime_s"), up);
+//   j.beginArray(F("tasks"));
+//   for (...) { j.beginObject(); j.field(F("name"), t.name); j.endObject(); }
+//   j.endArray();
+//   j.endObject();
+//
+// Een bestaande writer (void(Print&)) nest je met raw(): j.key(F("x")); w(j.raw());
+class JsonWriter {
+public:
+  explicit JsonWriter(Print& out) : _out(out), _esc(out) {}
+
+  JsonWriter& beginObject() { sep(); return open('{'); }
+  JsonWriter& beginArray()  { sep(); return open('['); }
+  template <typename K> JsonWriter& beginObject(K k) { key(k); return open('{'); }
+  template <typename K> JsonWriter& beginArray(K k)  { key(k); return open('['); }
+  JsonWriter& endObject() { return close('}'); }
+  JsonWriter& endArray()  { return close(']'); }
+
+  JsonWriter& key(const __FlashStringHelper* k) { sep(); _out.print('"'); _out.print(k); return keyDone(); }
+  JsonWriter& key(const char* k)                { sep(); _out.print('"'); _out.print(k); return keyDone(); }
+
+  JsonWriter& value(const char* s) {
+    if (!s) return null();
+    sep(); _out.print('"'); _esc.print(s); _out.print('"');
+    return *this;
+  }
+  JsonWriter& value(const String& s) { return value(s.c_str()); }
+  JsonWriter& value(const Printable& p) {               // bv. IPAddress, zonder toString()
+    sep(); _out.print('"'); p.printTo(_esc); _out.print('"');
+    return *this;
+  }
+  JsonWriter& value(bool b) { sep(); _out.print(b ? F("true") : F("false")); return *this; }
+
+  template <typename T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value &&
+                                                !std::is_same<T, char>::value, int>::type = 0>
+  JsonWriter& value(T v) {
+    sep();
+    if (std::is_signed<T>::value) _out.print((long long)v); else _out.print((unsigned long long)v);
+    return *this;
+  }
+
+  // Niet-eindige waarden (NAN = geen meting) worden null.
+  JsonWriter& value(double v, uint8_t digits = 2) {
+    if (isnan(v) || isinf(v)) return null();
+    sep(); _out.print(v, digits);
+    return *this;
+  }
+  JsonWriter& value(float v, uint8_t digits = 2) { return value((double)v, digits); }
+
+  JsonWriter& null() { sep(); _out.print(F("null")); return *this; }
+
+  template <typename K, typename V> JsonWriter& field(K k, const V& v) { key(k); return value(v); }
+  template <typename K> JsonWriter& field(K k, float v, uint8_t digits)  { key(k); return value(v, digits); }
+  template <typename K> JsonWriter& field(K k, double v, uint8_t digits) { key(k); return value(v, digits); }
+  template <typename K> JsonWriter& fieldNull(K k) { key(k); return null(); }
+
+  // Voor een complete JSON-waarde van een andere writer.
+  Print& raw() { sep(); return _out; }
+
+private:
+  // Escapet wat erdoorheen gaat; veilige stukken gaan in één write() door.
+  class Escaper : public Print {
+  public:
+    explicit Escaper(Print& out) : _out(out) {}
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* p, size_t len) override {
+      size_t run = 0;
+      for (size_t i=0; i<len; ++i) {
+        const uint8_t c = p[i];
+        if (c >= 0x20 && c != '"' && c != '\\') { ++run; continue; }
+        if (run) { _out.write(p + i - run, run); run = 0; }
+        switch (c) {
+          case '"':  _out.print(F("\\\"")); break;
+          case '\\': _out.print(F("\\\\")); break;
+          case '\n': _out.print(F("\\n"));  break;
+          case '\r': _out.print(F("\\r"));  break;
+          case '\t': _out.print(F("\\t"));  break;
+          default: {
+            static const char HEX_DIGITS[] = "0123456789abcdef";
+            _out.print(F("\\u00")); _out.print(HEX_DIGITS[c >> 4]); _out.print(HEX_DIGITS[c & 0xF]);
+          }
+        }
+      }
+      if (run) _out.write(p + len - run, run);
+      return len;
+    }
+  private:
+    Print& _out;
+  };
+
+  // Komma vóór elk element behalve het eerste; niet na een key.
+  void sep() {
+    if (_afterKey) { _afterKey = false; return; }
+    if (!_depth) return;
+    const uint32_t bit = 1u << (_depth - 1);
+    if (_hasItems & bit) _out.print(',');
+    else _hasItems |= bit;
+  }
+  JsonWriter& keyDone() { _out.print(F("\":")); _afterKey = true; return *this; }
+  JsonWriter& open(char c) {
+    _afterKey = false;                  // key is nu gebruikt
+    _out.print(c);
+    if (_depth < 32) { ++_depth; _hasItems &= ~(1u << (_depth - 1)); }
+    return *this;
+  }
+  JsonWriter& close(char c) {
+    _out.print(c);
+    if (_depth) --_depth;
+    return *this;
+  }
+
+  Print&   _out;
+  Escaper  _esc;
+  uint32_t _hasItems = 0;     // bit n: niveau n+1 heeft al een element
+  uint8_t  _depth = 0;
+  bool     _afterKey = false;
+};
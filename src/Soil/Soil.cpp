@@ -0,0 +1,21 @@
+#include "Soil.h"
+
+SoilSensor SoilService;
+
+void SoilSensor::begin(uint8_t pin, int rawDry, int rawWet) {
+  _pin = pin;
+  _rawDry = rawDry;
+  _rawWet = rawWet;
+  Serial.printf("[Soil] Initialized on pin %u (dry=%d, wet=%d)\n", _pin, _rawDry, _rawWet);
+}
+
+bool SoilSensor::read() {
+  if (_pin == 255) return false;
+  const int raw = analogRead(_pin);
+  int pct = map(raw, _rawDry, _rawWet, 0, 100);
+  _raw = raw;
+  _pct = constrain(pct, 0, 100);
+  _reads++;
+  Serial.printf("[Soil] %d (%d%%)\n", _raw, _pct);
+  return true;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <Arduino.h>
+
+class SoilSensor {
+public:
+  // rawDry/rawWet: ADC-waarden bij droge resp. natte grond (kalibreer zelf!)
+  void begin(uint8_t pin, int rawDry = 3500, int rawWet = 1200);
+  bool read();                               // actieve uitlezing
+
+  int raw()     const { return _raw; }
+  int percent() const { return _pct; }
+  uint32_t reads() const { return _reads; }
+
+private:
+  uint8_t _pin = 255;
+  int _rawDry = 3500;
+  int _rawWet = 1200;
+
+  int _raw = -1;
+  int _pct = -1;
+  uint32_t _reads = 0;
+};
+
+// Global singleton (optioneel)
+extern SoilSensor SoilService;
@@ -0,0 +1,298 @@
+#include "HeapProfile.h"
+#include "IdleLoad.h"
+#include "History.h"
+#include <Json/JsonWriter.h>
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// Heap-profiel in drie lagen:
+//  - altijd: failed-alloc callback (kost niets zolang allocaties slagen);
+//  - -DTASKMONITOR_HEAP_PROFILE: per-route scopes (calls + netto heap-delta)
+//    en, als de IDF heap hooks aan staan (CONFIG_HEAP_USE_HOOKS), tellers per
+//    task en per route voor iedere malloc/free;
+//  - CONFIG_HEAP_TRACING_STANDALONE: aan/uit te zetten leak-trace (live blocks).
+
+#if defined(TASKMONITOR_HEAP_PROFILE) && CONFIG_HEAP_USE_HOOKS
+  #define TM_HEAP_HOOKS 1
+#else
+  #define TM_HEAP_HOOKS 0
+#endif
+
+#if defined(TASKMONITOR_HEAP_PROFILE) && CONFIG_HEAP_TRACING_STANDALONE
+  #include <esp_heap_trace.h>
+  #define TM_HEAP_TRACE 1
+#else
+  #define TM_HEAP_TRACE 0
+#endif
+
+namespace TaskMonitor { namespace detail {
+
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// ---------------- failed allocs ----------------
+struct FailedAlloc {
+  uint32_t ms;
+  uint32_t size;
+  uint32_t caps;
+  char     task[configMAX_TASK_NAME_LEN];
+  const char* route;
+};
+static const uint8_t FAIL_RING = 8;
+static FailedAlloc s_fail[FAIL_RING];
+static uint32_t    s_failCount = 0;
+static uint32_t    s_failBytes = 0;
+
+// ---------------- routes ----------------
+struct RouteStat {
+  const char* name;      // string literal van de aanroeper
+  uint32_t calls;
+  uint32_t allocs;       // alleen met heap hooks
+  uint32_t bytes;        // alleen met heap hooks
+  int32_t  retained;     // som van (free voor - free na) over alle calls
+};
+static const uint8_t MAX_ROUTES = 16;
+static RouteStat     s_routes[MAX_ROUTES];
+static uint8_t       s_routeCount = 0;
+static TaskHandle_t  s_routeTask  = nullptr;   // task die nu in een route scope zit
+static int8_t        s_routeIdx   = -1;
+
+// ---------------- per task (heap hooks) ----------------
+#if TM_HEAP_HOOKS
+struct TaskHeap { TaskHandle_t h; uint32_t allocs; uint32_t frees; uint32_t bytes; };
+static const uint8_t MAX_TASK_HEAP = 16;
+static TaskHeap s_taskHeap[MAX_TASK_HEAP];
+static uint32_t s_untracked = 0;              // ISR of tabel vol
+
+static inline TaskHeap* IRAM_ATTR taskSlot(TaskHandle_t h) {
+  for (uint8_t i=0; i<MAX_TASK_HEAP; ++i) {
+    if (s_taskHeap[i].h == h) return &s_taskHeap[i];
+    if (s_taskHeap[i].h == nullptr) { s_taskHeap[i].h = h; return &s_taskHeap[i]; }
+  }
+  return nullptr;
+}
+
+extern "C" void IRAM_ATTR esp_heap_trace_alloc_hook(void* ptr, size_t size, uint32_t caps) {
+  (void)caps;
+  if (!ptr) return;
+  if (xPortInIsrContext()) { s_untracked++; return; }
+  TaskHandle_t h = xTaskGetCurrentTaskHandle();
+  portENTER_CRITICAL_ISR(&s_mux);
+  TaskHeap* t = taskSlot(h);
+  if (t) { t->allocs++; t->bytes += size; } else s_untracked++;
+  if (h == s_routeTask && s_routeIdx >= 0) { s_routes[s_routeIdx].allocs++; s_routes[s_routeIdx].bytes += size; }
+  portEXIT_CRITICAL_ISR(&s_mux);
+}
+
+extern "C" void IRAM_ATTR esp_heap_trace_free_hook(void* ptr) {
+  if (!ptr || xPortInIsrContext()) return;
+  TaskHandle_t h = xTaskGetCurrentTaskHandle();
+  portENTER_CRITICAL_ISR(&s_mux);
+  TaskHeap* t = taskSlot(h);
+  if (t) t->frees++;
+  portEXIT_CRITICAL_ISR(&s_mux);
+}
+#endif
+
+// ---------------- heap tracing ----------------
+#if TM_HEAP_TRACE
+static const size_t TRACE_RECORDS = 64;
+static heap_trace_record_t s_records[TRACE_RECORDS];
+static bool s_traceInit = false;
+static bool s_traceOn   = false;
+#endif
+
+static void onAllocFailed(size_t size, uint32_t caps, const char* function_name) {
+  (void)function_name;
+  // Geen allocaties/prints hier: we zitten midden in een mislukte malloc.
+  const char* name = xPortInIsrContext() ? "(isr)" : pcTaskGetName(nullptr);
+  portENTER_CRITICAL_ISR(&s_mux);
+  FailedAlloc& f = s_fail[s_failCount % FAIL_RING];
+  f.ms   = nowMs();
+  f.size = (uint32_t)size;
+  f.caps = caps;
+  strncpy(f.task, name ? name : "?", sizeof(f.task) - 1);
+  f.task[sizeof(f.task) - 1] = '\0';
+  f.route = (s_routeIdx >= 0 && xTaskGetCurrentTaskHandle() == s_routeTask) ? s_routes[s_routeIdx].name : nullptr;
+  s_failCount++;
+  s_failBytes += (uint32_t)size;
+  portEXIT_CRITICAL_ISR(&s_mux);
+}
+
+// ---------------- public (detail) ----------------
+void heapProfileBegin() {
+  static bool done = false;
+  if (done) return;
+  done = true;
+  heap_caps_register_failed_alloc_callback(&onAllocFailed);
+#if defined(TASKMONITOR_HEAP_PROFILE)
+  Serial.printf("[SYS] Heap profile on (hooks=%d, trace=%d)\n", TM_HEAP_HOOKS, TM_HEAP_TRACE);
+#endif
+}
+
+int8_t heapRouteEnter(const char* route, uint32_t& freeBefore) {
+#if defined(TASKMONITOR_HEAP_PROFILE)
+  freeBefore = (uint32_t)heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  int8_t idx = -1;
+  portENTER_CRITICAL(&s_mux);
+  for (uint8_t i=0; i<s_routeCount; ++i) {
+    if (s_routes[i].name == route || strcmp(s_routes[i].name, route) == 0) { idx = (int8_t)i; break; }
+  }
+  if (idx < 0 && s_routeCount < MAX_ROUTES) {
+    idx = (int8_t)s_routeCount++;
+    s_routes[idx] = RouteStat{route, 0, 0, 0, 0};
+  }
+  if (idx >= 0) {
+    s_routes[idx].calls++;
+    s_routeTask = xTaskGetCurrentTaskHandle();
+    s_routeIdx  = idx;
+  }
+  portEXIT_CRITICAL(&s_mux);
+  return idx;
+#else
+  (void)route; freeBefore = 0;
+  return -1;
+#endif
+}
+
+void heapRouteLeave(int8_t idx, uint32_t freeBefore) {
+  if (idx < 0) return;
+  const uint32_t freeAfter = (uint32_t)heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  portENTER_CRITICAL(&s_mux);
+  s_routes[idx].retained += (int32_t)(freeBefore - freeAfter);
+  s_routeTask = nullptr;
+  s_routeIdx  = -1;
+  portEXIT_CRITICAL(&s_mux);
+}
+
+bool heapTraceStart() {
+#if TM_HEAP_TRACE
+  if (!s_traceInit) {
+    if (heap_trace_init_standalone(s_records, TRACE_RECORDS) != ESP_OK) return false;
+    s_traceInit = true;
+  }
+  s_traceOn = (heap_trace_start(HEAP_TRACE_LEAKS) == ESP_OK);
+  return s_traceOn;
+#else
+  return false;
+#endif
+}
+
+bool heapTraceStop() {
+#if TM_HEAP_TRACE
+  if (!s_traceOn) return false;
+  s_traceOn = false;
+  return heap_trace_stop() == ESP_OK;
+#else
+  return false;
+#endif
+}
+
+void writeJsonHeap(Print& out) {
+  const uint32_t free8   = (uint32_t)heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  const uint32_t min8    = (uint32_t)heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+  const uint32_t largest = (uint32_t)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+  const float frag = free8 ? 100.f * (1.f - (float)largest / (float)free8) : 0.f;
+
+  JsonWriter j(out);
+  j.beginObject();
+  j.field(F("free"),     free8);
+  j.field(F("min"),      min8);
+  j.field(F("largest"),  largest);
+  j.field(F("frag_pct"), frag, 1);
+#if defined(TASKMONITOR_HEAP_PROFILE)
+  j.field(F("profile"), true);
+#else
+  j.field(F("profile"), false);
+#endif
+
+  // failed allocs (nieuwste eerst)
+  FailedAlloc fails[FAIL_RING];
+  portENTER_CRITICAL(&s_mux);
+  const uint32_t failCount = s_failCount, failBytes = s_failBytes;
+  memcpy(fails, s_fail, sizeof(fails));
+  portEXIT_CRITICAL(&s_mux);
+  j.beginObject(F("failed"));
+  j.field(F("count"), failCount);
+  j.field(F("bytes"), failBytes);
+  j.beginArray(F("last"));
+  const uint32_t shown = failCount < FAIL_RING ? failCount : FAIL_RING;
+  for (uint32_t i=0; i<shown; ++i) {
+    const FailedAlloc& f = fails[(failCount - 1 - i) % FAIL_RING];
+    j.beginObject();
+    j.field(F("ms"),    f.ms);
+    j.field(F("size"),  f.size);
+    j.field(F("caps"),  f.caps);
+    j.field(F("task"),  f.task);
+    j.field(F("route"), f.route);           // nullptr => null
+    j.endObject();
+  }
+  j.endArray();
+  j.endObject();
+
+  // routes
+  RouteStat routes[MAX_ROUTES];
+  portENTER_CRITICAL(&s_mux);
+  const uint8_t routeCount = s_routeCount;
+  memcpy(routes, s_routes, sizeof(routes));
+  portEXIT_CRITICAL(&s_mux);
+  j.beginArray(F("routes"));
+  for (uint8_t i=0; i<routeCount; ++i) {
+    j.beginObject();
+    j.field(F("route"), routes[i].name);
+    j.field(F("calls"), routes[i].calls);
+#if TM_HEAP_HOOKS
+    j.field(F("allocs"), routes[i].allocs);
+    j.field(F("bytes"),  routes[i].bytes);
+#endif
+    j.field(F("retained"), routes[i].retained);
+    j.endObject();
+  }
+  j.endArray();
+
+#if TM_HEAP_HOOKS
+  // tasks: namen uit de run-time snapshot (alleen levende tasks)
+  TaskHeap heaps[MAX_TASK_HEAP];
+  portENTER_CRITICAL(&s_mux);
+  memcpy(heaps, s_taskHeap, sizeof(heaps));
+  const uint32_t untracked = s_untracked;
+  portEXIT_CRITICAL(&s_mux);
+  TaskLoad names[MAX_TASK_LOADS];
+  const size_t nameCount = idleLoadTasks(names, MAX_TASK_LOADS, nullptr);
+  j.field(F("untracked"), untracked);
+  j.beginArray(F("tasks"));
+  for (uint8_t i=0; i<MAX_TASK_HEAP && heaps[i].h; ++i) {
+    const char* name = "(exited)";
+    for (size_t k=0; k<nameCount; ++k) if (names[k].h == heaps[i].h) { name = names[k].name; break; }
+    j.beginObject();
+    j.field(F("name"),   name);
+    j.field(F("allocs"), heaps[i].allocs);
+    j.field(F("frees"),  heaps[i].frees);
+    j.field(F("live"),   (int32_t)(heaps[i].allocs - heaps[i].frees));
+    j.field(F("bytes"),  heaps[i].bytes);
+    j.endObject();
+  }
+  j.endArray();
+#endif
+
+#if TM_HEAP_TRACE
+  size_t liveBytes = 0;
+  const size_t records = heap_trace_get_count();
+  for (size_t i=0; i<records; ++i) {
+    heap_trace_record_t r;
+    if (heap_trace_get(i, &r) == ESP_OK) liveBytes += r.size;
+  }
+  j.beginObject(F("trace"));
+  j.field(F("active"),      s_traceOn);
+  j.field(F("live_blocks"), (unsigned)records);
+  j.field(F("live_bytes"),  (unsigned)liveBytes);
+  j.endObject();
+#endif
+
+  // fragmentatie over tijd (1 min tier)
+  j.key(F("frag_history"));
+  writeJsonHistory(j.raw(), HM_HEAP_FRAG, HT_1M);
+  j.endObject();
+}
+
+}} // namespace TaskMonitor::detail
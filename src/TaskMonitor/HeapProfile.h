@@ -0,0 +1,19 @@
+#pragma once
+#include <Arduino.h>
+
+namespace TaskMonitor { namespace detail {
+  // Registreer de failed-alloc callback (altijd) en, met
+  // -DTASKMONITOR_HEAP_PROFILE, de per-task/per-route tellers.
+  void heapProfileBegin();
+
+  // Route-attributie (zie TaskMonitor::HeapRouteScope).
+  int8_t heapRouteEnter(const char* route, uint32_t& freeBefore);
+  void   heapRouteLeave(int8_t idx, uint32_t freeBefore);
+
+  // Heap-tracing (alleen als ESP-IDF heap tracing standalone beschikbaar is).
+  bool heapTraceStart();
+  bool heapTraceStop();
+
+  // /sys/heap JSON: heap-stand, fragmentatie, failed allocs, profielen.
+  void writeJsonHeap(Print& out);
+}}
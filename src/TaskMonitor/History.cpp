@@ -0,0 +1,201 @@
+#include "History.h"
+#include "IdleLoad.h"
+#include <esp_timer.h>
+#include <esp_wifi.h>
+#include <esp_heap_caps.h>
+
+// Vaste-grootte history in drie resoluties. Opslag is struct-of-arrays: per
+// tier en per metric één aaneengesloten rij int32's, zodat een /sys/history
+// request precies één rij lineair leest. Elke 60 punten van een tier worden
+// samengevat (gemiddelde of minimum) tot één punt van de volgende tier.
+
+namespace TaskMonitor { namespace detail {
+
+static const int32_t NO_VALUE = INT32_MIN;   // bv. geen RSSI zonder STA-link
+
+static const uint16_t TIER_CAP[HT_COUNT]    = { 120, 120, 48 };   // 2 min, 2 uur, 2 dagen
+static const uint16_t TIER_OFF[HT_COUNT]    = { 0, 120, 240 };
+static const uint16_t POOL_SIZE             = 288;
+static const uint16_t MAX_CAP               = 120;
+static const uint32_t TIER_STEP_S[HT_COUNT] = { 1, 60, 3600 };
+static const uint8_t  FOLD = 60;                                   // punten per volgende tier
+
+static const char* const METRIC_NAMES[HM_COUNT] = {
+  "heap_free", "heap_min", "heap_largest", "cpu0", "cpu1", "rssi", "heap_frag"
+};
+static const char* const TIER_NAMES[HT_COUNT] = { "1s", "1m", "1h" };
+
+// Voor "slechtste waarde" metrics is het minimum interessanter dan het gemiddelde.
+static const bool FOLD_MIN[HM_COUNT] = { false, true, true, false, false, false, false };
+
+struct TierState { uint16_t head; uint16_t count; uint32_t lastS; };
+struct Fold {
+  int64_t  sum[HM_COUNT];
+  int32_t  min[HM_COUNT];
+  uint8_t  valid[HM_COUNT];
+  uint8_t  points;
+};
+
+static int32_t            s_pool[HM_COUNT][POOL_SIZE];
+static TierState          s_tier[HT_COUNT];
+static Fold               s_fold[HT_COUNT - 1];      // alleen door de timer-callback gebruikt
+static portMUX_TYPE       s_mux = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t s_timer = nullptr;
+
+// ---------------- schrijven (esp_timer callback) ----------------
+static void resetFold(Fold& f) {
+  for (uint8_t m=0; m<HM_COUNT; ++m) { f.sum[m] = 0; f.min[m] = INT32_MAX; f.valid[m] = 0; }
+  f.points = 0;
+}
+
+static void push(uint8_t t, const int32_t* v, uint32_t stampS) {
+  TierState& st = s_tier[t];
+  portENTER_CRITICAL(&s_mux);
+  for (uint8_t m=0; m<HM_COUNT; ++m) s_pool[m][TIER_OFF[t] + st.head] = v[m];
+  st.head  = (uint16_t)((st.head + 1) % TIER_CAP[t]);
+  if (st.count < TIER_CAP[t]) st.count++;
+  st.lastS = stampS;
+  portEXIT_CRITICAL(&s_mux);
+
+  if (t + 1 >= HT_COUNT) return;
+  Fold& f = s_fold[t];
+  for (uint8_t m=0; m<HM_COUNT; ++m) {
+    if (v[m] == NO_VALUE) continue;
+    f.sum[m] += v[m];
+    if (v[m] < f.min[m]) f.min[m] = v[m];
+    f.valid[m]++;
+  }
+  if (++f.points < FOLD) return;
+
+  int32_t out[HM_COUNT];
+  for (uint8_t m=0; m<HM_COUNT; ++m) {
+    if (!f.valid[m])     out[m] = NO_VALUE;
+    else if (FOLD_MIN[m]) out[m] = f.min[m];
+    else                  out[m] = (int32_t)(f.sum[m] / f.valid[m]);
+  }
+  resetFold(f);
+  push(t + 1, out, stampS);
+}
+
+static void sampleOnce(void*) {
+  int32_t v[HM_COUNT];
+  v[HM_HEAP_FREE]    = (int32_t)heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  v[HM_HEAP_MIN]     = (int32_t)heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+  v[HM_HEAP_LARGEST] = (int32_t)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+  v[HM_HEAP_FRAG]    = v[HM_HEAP_FREE] ? 1000 - (int32_t)((int64_t)v[HM_HEAP_LARGEST] * 1000 / v[HM_HEAP_FREE]) : 0;
+
+  float l0 = 0.f, l1 = 0.f;
+  idleLoadGet(l0, l1, nullptr);
+  v[HM_CPU0] = isnan(l0) ? NO_VALUE : (int32_t)(l0 * 10.0f + 0.5f);
+  v[HM_CPU1] = isnan(l1) ? NO_VALUE : (int32_t)(l1 * 10.0f + 0.5f);
+
+  wifi_ap_record_t ap;
+  v[HM_RSSI] = (esp_wifi_sta_get_ap_info(&ap) == ESP_OK) ? (int32_t)ap.rssi : NO_VALUE;
+
+  push(HT_1S, v, nowMs() / 1000UL);
+}
+
+// ---------------- lezen ----------------
+// Kopie van één rij (oudste eerst); retourneert aantal punten.
+static uint16_t copySeries(HistMetric m, HistTier t, int32_t* out, uint32_t& lastS) {
+  const uint16_t cap = TIER_CAP[t];
+  const int32_t* row = &s_pool[m][TIER_OFF[t]];
+  portENTER_CRITICAL(&s_mux);
+  const TierState st = s_tier[t];
+  uint16_t idx = (uint16_t)((st.head + cap - st.count) % cap);
+  for (uint16_t i=0; i<st.count; ++i) {
+    out[i] = row[idx];
+    if (++idx == cap) idx = 0;
+  }
+  portEXIT_CRITICAL(&s_mux);
+  lastS = st.lastS;
+  return st.count;
+}
+
+// ---------------- public (detail) ----------------
+void historyBegin() {
+  if (s_timer) return;
+  for (uint8_t t=0; t<HT_COUNT-1; ++t) resetFold(s_fold[t]);
+
+  esp_timer_create_args_t args = {};
+  args.callback = &sampleOnce;
+  args.name     = "tm_history";
+  if (esp_timer_create(&args, &s_timer) != ESP_OK) {
+    s_timer = nullptr;
+    Serial.println(F("[SYS] History timer create FAILED"));
+    return;
+  }
+  esp_timer_start_periodic(s_timer, 1000000ULL);
+  Serial.printf("[SYS] History started (%u bytes)\n", (unsigned)sizeof(s_pool));
+}
+
+bool historyMetric(const char* name, HistMetric& out) {
+  if (!name) return false;
+  for (uint8_t m=0; m<HM_COUNT; ++m) {
+    if (strcmp(name, METRIC_NAMES[m]) == 0) { out = (HistMetric)m; return true; }
+  }
+  return false;
+}
+
+bool historyTier(const char* name, HistTier& out) {
+  if (!name) return false;
+  for (uint8_t t=0; t<HT_COUNT; ++t) {
+    if (strcmp(name, TIER_NAMES[t]) == 0) { out = (HistTier)t; return true; }
+  }
+  return false;
+}
+
+// JSON: waarde i = som van d[0..i]; null = geen meting (som blijft gelijk).
+void writeJsonHistory(Print& out, HistMetric m, HistTier t) {
+  int32_t buf[MAX_CAP];
+  uint32_t lastS = 0;
+  const uint16_t n = copySeries(m, t, buf, lastS);
+
+  out.print(F("{\"metric\":\"")); out.print(METRIC_NAMES[m]);
+  out.print(F("\",\"tier\":\""));  out.print(TIER_NAMES[t]);
+  out.print(F("\",\"step_s\":"));  out.print(TIER_STEP_S[t]);
+  out.print(F(",\"last_s\":"));    out.print(lastS);
+  out.print(F(",\"count\":"));     out.print(n);
+  out.print(F(",\"d\":["));
+  int32_t prev = 0;
+  for (uint16_t i=0; i<n; ++i) {
+    if (i) out.print(',');
+    if (buf[i] == NO_VALUE) { out.print(F("null")); continue; }
+    out.print(buf[i] - prev);
+    prev = buf[i];
+  }
+  out.print(F("]}"));
+}
+
+static void writeVarint(Print& out, uint32_t v) {
+  while (v >= 0x80) { out.write((uint8_t)(v | 0x80)); v >>= 7; }
+  out.write((uint8_t)v);
+}
+
+// Binair (little endian):
+//   "TH" ver(1) metric(1) tier(1) step_s(u32) last_s(u32) count(u16)
+//   count x varint: 0 = geen meting, anders zigzag(delta) + 1
+void writeBinHistory(Print& out, HistMetric m, HistTier t) {
+  int32_t buf[MAX_CAP];
+  uint32_t lastS = 0;
+  const uint16_t n = copySeries(m, t, buf, lastS);
+
+  const uint32_t step = TIER_STEP_S[t];
+  const uint8_t hdr[15] = {
+    'T', 'H', 1, (uint8_t)m, (uint8_t)t,
+    (uint8_t)step, (uint8_t)(step >> 8), (uint8_t)(step >> 16), (uint8_t)(step >> 24),
+    (uint8_t)lastS, (uint8_t)(lastS >> 8), (uint8_t)(lastS >> 16), (uint8_t)(lastS >> 24),
+    (uint8_t)n, (uint8_t)(n >> 8)
+  };
+  out.write(hdr, sizeof(hdr));
+
+  int32_t prev = 0;
+  for (uint16_t i=0; i<n; ++i) {
+    if (buf[i] == NO_VALUE) { writeVarint(out, 0); continue; }
+    const int32_t d = buf[i] - prev;
+    prev = buf[i];
+    writeVarint(out, (((uint32_t)d << 1) ^ (uint32_t)(d >> 31)) + 1);
+  }
+}
+
+}} // namespace TaskMonitor::detail
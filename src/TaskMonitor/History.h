@@ -0,0 +1,31 @@
+#pragma once
+#include <Arduino.h>
+
+namespace TaskMonitor { namespace detail {
+  // Metrics die in de history ring worden bewaard.
+  enum HistMetric : uint8_t {
+    HM_HEAP_FREE = 0,
+    HM_HEAP_MIN,
+    HM_HEAP_LARGEST,
+    HM_CPU0,          // 0.1% eenheden
+    HM_CPU1,          // 0.1% eenheden
+    HM_RSSI,          // dBm
+    HM_HEAP_FRAG,     // 0.1% eenheden: 1 - largest/free
+    HM_COUNT
+  };
+
+  // Resoluties: 1 s, 1 min (gemiddelde/minimum van 60 s), 1 h (van 60 min).
+  enum HistTier : uint8_t { HT_1S = 0, HT_1M, HT_1H, HT_COUNT };
+
+  // Start de 1 s sampler (esp_timer) die alle tiers vult.
+  void historyBegin();
+
+  // Naam -> id; false als onbekend. Namen: heap_free, heap_min, heap_largest,
+  // cpu0, cpu1, rssi, heap_frag resp. 1s, 1m, 1h.
+  bool historyMetric(const char* name, HistMetric& out);
+  bool historyTier(const char* name, HistTier& out);
+
+  // Delta-gecodeerde serie (oudste eerst) als JSON of compact binair.
+  void writeJsonHistory(Print& out, HistMetric m, HistTier t);
+  void writeBinHistory(Print& out, HistMetric m, HistTier t);
+}}
@@ -4,118 +4,211 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 
+// CPU-load via FreeRTOS run-time stats: elke task heeft een runtime-teller
+// (µs, gevoed door esp_timer). Per venster nemen we één snapshot met
+// uxTaskGetSystemState en rekenen we delta's uit t.o.v. het vorige snapshot.
+// Load per core = 100% - aandeel van de IDLE-task van die core.
+// Geen busy-loops, dus automatic light sleep blijft mogelijk.
+
+#if (configGENERATE_RUN_TIME_STATS == 1) && (configUSE_TRACE_FACILITY == 1)
+  #define TM_HAVE_RUNTIME_STATS 1
+#else
+  #define TM_HAVE_RUNTIME_STATS 0
+  #warning "TaskMonitor: configGENERATE_RUN_TIME_STATS/configUSE_TRACE_FACILITY uit in sdkconfig: geen CPU-load (cpu_load = null)"
+#endif
+
 namespace TaskMonitor { namespace detail {
 
 // ---------------- config ----------------
-static uint32_t  s_baselineWindowMs = 250;
 static uint32_t  s_measureWindowMs  = 500;
 
-// ---------------- idle spin counters ----------------
-static volatile uint32_t s_spin0 = 0;
-static volatile uint32_t s_spin1 = 0;
-
-// baseline spins (max idle) per core
-static uint32_t  s_base0 = 1;
-static uint32_t  s_base1 = 1;
-static bool      s_calibrated = false;
-
-// idle meter tasks
-static TaskHandle_t s_idleTask0 = nullptr;
-static TaskHandle_t s_idleTask1 = nullptr;
-
-// background sampler task
-static TaskHandle_t s_samplerTask = nullptr;
+// ---------------- periodieke accounting timer ----------------
+static esp_timer_handle_t s_timer = nullptr;
 
 // cached load + timestamp
 static float     s_lastLoad0 = 0.f;
 static float     s_lastLoad1 = 0.f;
-static uint32_t  s_lastStamp = 0;
+static uint32_t  s_lastStamp = 0;       // 0 = nog geen meting
+
+// gepubliceerde per-task tabel (beschermd door s_mux)
+static TaskLoad     s_tasks[MAX_TASK_LOADS];
+static size_t       s_taskCount = 0;
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+
+#if TM_HAVE_RUNTIME_STATS
+// vorig snapshot (alleen gebruikt vanuit de timer-callback)
+struct PrevRun { TaskHandle_t h; uint32_t rt; };
+static TaskStatus_t s_status[MAX_TASK_LOADS];
+static TaskLoad     s_fresh[MAX_TASK_LOADS];
+static PrevRun      s_prev[MAX_TASK_LOADS];
+static size_t       s_prevCount = 0;
+static uint32_t     s_prevTotal = 0;
+static bool         s_havePrev  = false;
+static bool         s_tooMany   = false;   // laatste snapshot overgeslagen (> MAX_TASK_LOADS tasks)
+#endif
 
 // ---------------- utils ----------------
 uint32_t nowMs() { return (uint32_t)(esp_timer_get_time() / 1000ULL); }
 
-static inline void sampleSpins(uint32_t windowMs, uint32_t &d0, uint32_t &d1) {
-  const uint32_t a0 = s_spin0, a1 = s_spin1;
-  vTaskDelay(pdMS_TO_TICKS(windowMs));
-  const uint32_t b0 = s_spin0, b1 = s_spin1;
-  d0 = (b0 - a0);
-  d1 = (b1 - a1);
+static inline float clampPct(float v) {
+  if (v < 0.0f)   return 0.0f;
+  if (v > 100.0f) return 100.0f;
+  return v;
 }
 
-static inline float spinsToLoadPct(uint32_t spins, uint32_t base) {
-  if (base == 0) base = 1;
-  float idlePct = 100.0f * (float)spins / (float)base;
-  if (idlePct > 100.0f) idlePct = 100.0f;
-  float loadPct = 100.0f - idlePct;
-  if (loadPct < 0.0f) loadPct = 0.0f;
-  if (loadPct > 100.0f) loadPct = 100.0f;
-  return loadPct;
+#if TM_HAVE_RUNTIME_STATS
+static uint32_t prevRunTime(TaskHandle_t h, bool &found) {
+  for (size_t i=0; i<s_prevCount; ++i) {
+    if (s_prev[i].h == h) { found = true; return s_prev[i].rt; }
+  }
+  found = false;
+  return 0;
 }
 
-// ---------------- idle meter tasks ----------------
-static void IdleMeterTask0(void*) { for(;;){ s_spin0++; } }
-static void IdleMeterTask1(void*) { for(;;){ s_spin1++; } }
-
-// ---------------- calibration ----------------
-static void calibrateOnce() {
-  if (s_calibrated) return;
-  Serial.printf("[SYS] Calibrating (idle baseline) %ums...\n", s_baselineWindowMs);
-  uint32_t best0 = 0, best1 = 0;
-  for (int i=0; i<3; ++i) {
-    uint32_t d0=0, d1=0; sampleSpins(s_baselineWindowMs, d0, d1);
-    if (d0 > best0) best0 = d0;
-    if (d1 > best1) best1 = d1;
-  }
-  s_base0 = best0 ? best0 : 1;
-  s_base1 = best1 ? best1 : 1;
-  s_calibrated = true;
-  Serial.printf("[SYS] Baseline spins: core0=%u core1=%u\n", best0, best1);
+static int8_t coreOf(const TaskStatus_t& st, TaskHandle_t idle0, TaskHandle_t idle1) {
+  if (st.xHandle == idle0) return 0;
+  if (st.xHandle == idle1) return 1;
+#if (configTASKLIST_INCLUDE_COREID == 1)
+  if (st.xCoreID == 0 || st.xCoreID == 1) return (int8_t)st.xCoreID;
+#endif
+  return -1;
 }
 
-// ---------------- background load sampler ----------------
-static void LoadSamplerTask(void*) {
-  for(;;){
-    uint32_t d0=0, d1=0;
-    sampleSpins(s_measureWindowMs, d0, d1);
-    s_lastLoad0 = spinsToLoadPct(d0, s_base0);
-    s_lastLoad1 = spinsToLoadPct(d1, s_base1);
-    s_lastStamp = nowMs();
-    // mini breather om andere ready tasks kans te geven (zonder accuracy te raken)
-    vTaskDelay(pdMS_TO_TICKS(5));
+// ---------------- accounting (esp_timer callback) ----------------
+static void accountOnce(void*) {
+  uint32_t total = 0;
+  const UBaseType_t n = uxTaskGetSystemState(s_status, MAX_TASK_LOADS, &total);
+  if (n == 0) {
+    // Meer tasks dan MAX_TASK_LOADS: snapshot overslaan. Eén melding per
+    // overgang; de cijfers verouderen zichtbaar (cpu_status/cpu_age_ms).
+    if (!s_tooMany) Serial.printf("[SYS] CPU load paused: %u tasks > MAX_TASK_LOADS (%u)\n",
+                                  (unsigned)uxTaskGetNumberOfTasks(), (unsigned)MAX_TASK_LOADS);
+    s_tooMany = true;
+    return;
   }
-}
+  if (s_tooMany) Serial.println(F("[SYS] CPU load resumed"));
+  s_tooMany = false;
 
-// ---------------- public (detail) ----------------
-void idleLoadBegin(uint32_t baselineWindowMs, uint32_t measureWindowMs) {
-  s_baselineWindowMs = baselineWindowMs ? baselineWindowMs : 250;
-  s_measureWindowMs  = measureWindowMs  ? measureWindowMs  : 500;
+#if CONFIG_FREERTOS_UNICORE
+  TaskHandle_t idle0 = xTaskGetIdleTaskHandle();
+  TaskHandle_t idle1 = nullptr;
+#else
+  TaskHandle_t idle0 = xTaskGetIdleTaskHandleForCPU(0);
+  TaskHandle_t idle1 = xTaskGetIdleTaskHandleForCPU(1);
+#endif
+
+  const uint32_t dTotal = total - s_prevTotal; // wrap-safe (unsigned)
+  size_t   count = 0;
+  uint32_t dIdle0 = 0, dIdle1 = 0;
+
+  if (s_havePrev && dTotal > 0) {
+    // totale capaciteit = dTotal per core
+    const float capacity = (float)dTotal * (float)portNUM_PROCESSORS;
+    for (UBaseType_t i=0; i<n; ++i) {
+      const TaskStatus_t& st = s_status[i];
+      bool known = false;
+      const uint32_t before = prevRunTime(st.xHandle, known);
+      const uint32_t d = known ? (st.ulRunTimeCounter - before) : st.ulRunTimeCounter;
+
+      if (st.xHandle == idle0) dIdle0 = d;
+      if (st.xHandle == idle1) dIdle1 = d;
 
-  const UBaseType_t prioIdle = tskIDLE_PRIORITY; // 0
-  const uint32_t stackWords  = 1024;
+      TaskLoad& t = s_fresh[count++];
+      t.h        = st.xHandle;
+      strncpy(t.name, st.pcTaskName ? st.pcTaskName : "(null)", sizeof(t.name) - 1);
+      t.name[sizeof(t.name) - 1] = '\0';
+      t.core     = coreOf(st, idle0, idle1);
+      t.prio     = (uint8_t)st.uxCurrentPriority;
+      t.stackMin = (uint16_t)st.usStackHighWaterMark;
+      t.pct      = clampPct(100.0f * (float)d / capacity);
+    }
+  }
 
-  if (!s_idleTask0) {
-    xTaskCreatePinnedToCore(IdleMeterTask0, "IdleMeter0", stackWords, nullptr, prioIdle, &s_idleTask0, 0);
-    Serial.printf("[SYS] IdleMeter0 core0 (prio=%u)\n", (unsigned)prioIdle);
+  // snapshot bewaren voor volgende delta
+  for (UBaseType_t i=0; i<n; ++i) {
+    s_prev[i].h  = s_status[i].xHandle;
+    s_prev[i].rt = s_status[i].ulRunTimeCounter;
   }
-  if (!s_idleTask1) {
-    xTaskCreatePinnedToCore(IdleMeterTask1, "IdleMeter1", stackWords, nullptr, prioIdle, &s_idleTask1, 1);
-    Serial.printf("[SYS] IdleMeter1 core1 (prio=%u)\n", (unsigned)prioIdle);
+  s_prevCount = n;
+  s_prevTotal = total;
+  if (!s_havePrev || dTotal == 0) { s_havePrev = true; return; }
+
+  // hoogste CPU eerst (insertion sort; n <= MAX_TASK_LOADS)
+  for (size_t i=1; i<count; ++i) {
+    TaskLoad key = s_fresh[i];
+    size_t j = i;
+    while (j > 0 && s_fresh[j-1].pct < key.pct) { s_fresh[j] = s_fresh[j-1]; --j; }
+    s_fresh[j] = key;
   }
 
-  calibrateOnce();
+  const float load0 = clampPct(100.0f - 100.0f * (float)dIdle0 / (float)dTotal);
+  const float load1 = idle1 ? clampPct(100.0f - 100.0f * (float)dIdle1 / (float)dTotal) : 0.f;
+
+  portENTER_CRITICAL(&s_mux);
+  memcpy(s_tasks, s_fresh, count * sizeof(TaskLoad));
+  s_taskCount = count;
+  s_lastLoad0 = load0;
+  s_lastLoad1 = load1;
+  s_lastStamp = nowMs();
+  portEXIT_CRITICAL(&s_mux);
+}
+#endif
+
+// ---------------- public (detail) ----------------
+void idleLoadBegin(uint32_t measureWindowMs) {
+  s_measureWindowMs = measureWindowMs ? measureWindowMs : 500;
+  if (s_timer) return;
 
-  if (!s_samplerTask) {
-    const UBaseType_t prio = tskIDLE_PRIORITY + 1; // net boven idle
-    xTaskCreate(LoadSamplerTask, "LoadSampler", 2048, nullptr, prio, &s_samplerTask);
-    Serial.printf("[SYS] LoadSampler started (window=%ums)\n", s_measureWindowMs);
+#if TM_HAVE_RUNTIME_STATS
+  esp_timer_create_args_t args = {};
+  args.callback = &accountOnce;
+  args.name     = "tm_runtime";
+  if (esp_timer_create(&args, &s_timer) != ESP_OK) {
+    s_timer = nullptr;
+    Serial.println(F("[SYS] Runtime accounting timer create FAILED"));
+    return;
   }
+  accountOnce(nullptr); // eerste (basis)snapshot
+  esp_timer_start_periodic(s_timer, (uint64_t)s_measureWindowMs * 1000ULL);
+  Serial.printf("[SYS] Runtime accounting started (window=%ums)\n", s_measureWindowMs);
+#else
+  Serial.println(F("[SYS] CPU load unavailable (configGENERATE_RUN_TIME_STATS disabled)"));
+#endif
 }
 
 void idleLoadGet(float &core0, float &core1, uint32_t* ageMs) {
+  portENTER_CRITICAL(&s_mux);
   core0 = s_lastLoad0; core1 = s_lastLoad1;
-  if (ageMs) *ageMs = nowMs() - s_lastStamp;
+  const uint32_t stamp = s_lastStamp;
+  portEXIT_CRITICAL(&s_mux);
+  if (!stamp) core0 = core1 = NAN;               // niet beschikbaar of nog geen venster
+  if (ageMs) *ageMs = stamp ? nowMs() - stamp : 0;
+}
+
+const char* idleLoadStatus() {
+#if TM_HAVE_RUNTIME_STATS
+  if (!s_timer)     return "unavailable";
+  if (s_tooMany)    return "too_many_tasks";
+  if (!s_lastStamp) return "warming_up";
+  return "ok";
+#else
+  return "unavailable";
+#endif
+}
+
+size_t idleLoadTasks(TaskLoad* out, size_t max, uint32_t* ageMs) {
+  if (!out || !max) return 0;
+  portENTER_CRITICAL(&s_mux);
+  const size_t n = (s_taskCount < max) ? s_taskCount : max;
+  memcpy(out, s_tasks, n * sizeof(TaskLoad));
+  const uint32_t stamp = s_lastStamp;
+  portEXIT_CRITICAL(&s_mux);
+  if (ageMs) *ageMs = nowMs() - stamp;
+  return n;
 }
 
+uint32_t idleLoadWindowMs() { return s_measureWindowMs; }
+
 // ---------------- console helpers ----------------
 static void printHeapAndPsram() {
   const uint32_t heapFree = (uint32_t)ESP.getFreeHeap();
@@ -147,6 +240,28 @@ void printCpu() {
                 l0, l1, (unsigned long)age, s_measureWindowMs);
 }
 
+void printTaskLoads() {
+  TaskLoad tasks[MAX_TASK_LOADS];
+  uint32_t age = 0;
+  const size_t n = idleLoadTasks(tasks, MAX_TASK_LOADS, &age);
+
+  Serial.printf("\n-- CPU per task (run-time stats, window %ums, age %lums) --\n",
+                s_measureWindowMs, (unsigned long)age);
+  Serial.println(F("Name                Core Prio StackMin    CPU%"));
+  Serial.println(F("------------------------------------------------"));
+  for (size_t i=0; i<n; ++i) {
+    const TaskLoad& t = tasks[i];
+    Serial.printf("%-18s %4s %4u %8u %7.2f%%\n",
+      t.name,
+      (t.core==0?"0": t.core==1?"1":"-"),
+      (unsigned)t.prio,
+      (unsigned)t.stackMin,
+      t.pct
+    );
+  }
+  Serial.println(F("------------------------------------------------"));
+}
+
 void printFooter() {
   Serial.println(F("==================================\n"));
 }
@@ -1,11 +1,32 @@
 #pragma once
 #include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 
 namespace TaskMonitor { namespace detail {
-  // Start idle-meters (per core) + achtergrond-sampler task voor CPU-load.
-  void idleLoadBegin(uint32_t baselineWindowMs, uint32_t measureWindowMs);
+  // Max aantal tasks in één run-time snapshot.
+  static const size_t MAX_TASK_LOADS = 32;
+
+  // CPU-gebruik van één task over het laatste meetvenster.
+  struct TaskLoad {
+    TaskHandle_t h;
+    char     name[configMAX_TASK_NAME_LEN];
+    int8_t   core;       // 0/1, of -1 als de task niet gepind is
+    uint8_t  prio;
+    uint16_t stackMin;   // high-water mark (bytes; ESP-IDF telt in bytes)
+    float    pct;        // aandeel van de totale CPU-capaciteit (alle cores samen = 100%)
+  };
+
+  // Start run-time accounting (esp_timer, elke measureWindowMs een snapshot).
+  void idleLoadBegin(uint32_t measureWindowMs);
   // Lees gecachte load; ageMs (optioneel) = leeftijd van de meting in ms.
+  // NAN als er (nog) geen meting is, bv. zonder run-time stats.
   void idleLoadGet(float &core0, float &core1, uint32_t* ageMs);
+  // "ok", "warming_up", "too_many_tasks" (cijfers bevroren) of "unavailable".
+  const char* idleLoadStatus();
+  // Kopieer per-task load (gesorteerd, hoogste eerst); retourneert aantal.
+  size_t idleLoadTasks(TaskLoad* out, size_t max, uint32_t* ageMs);
+  uint32_t idleLoadWindowMs();
 
   // Helpers die ook door printers/JSON gebruikt worden
   uint32_t nowMs();
@@ -13,5 +34,6 @@ namespace TaskMonitor { namespace detail {
   // Console output helpers
   void printHeader();
   void printCpu();
+  void printTaskLoads();
   void printFooter();
 }}
@@ -1,9 +1,20 @@
 #include "JsonOut.h"
 #include "IdleLoad.h"
 #include <esp_system.h>
+#include <Json/JsonWriter.h>
 
 namespace TaskMonitor { namespace detail {
 
+struct InfoSection { const char* key; std::function<void(Print&)> writer; };
+static const uint8_t MAX_INFO_SECTIONS = 4;
+static InfoSection   s_sections[MAX_INFO_SECTIONS];
+
+void addInfoSection(const char* key, std::function<void(Print&)> writer) {
+  for (InfoSection& s : s_sections) {
+    if (!s.key || strcmp(s.key, key) == 0) { s.key = key; s.writer = writer; return; }
+  }
+}
+
 void writeJsonInfo(Print& out) {
   float l0=0.f, l1=0.f; uint32_t age=0;
   idleLoadGet(l0, l1, &age);
@@ -12,19 +23,50 @@ void writeJsonInfo(Print& out) {
   const uint32_t heapFree = (uint32_t)ESP.getFreeHeap();
   const uint32_t heapMin  = (uint32_t)ESP.getMinFreeHeap();
 
-  out.print(F("{\"uptime_s\":"));      out.print(up);
-  out.print(F(",\"heap_free\":"));     out.print(heapFree);
-  out.print(F(",\"heap_min\":"));      out.print(heapMin);
+  JsonWriter j(out);
+  j.beginObject();
+  j.field(F("uptime_s"),  up);
+  j.field(F("heap_free"), heapFree);
+  j.field(F("heap_min"),  heapMin);
 #if CONFIG_SPIRAM
-  out.print(F(",\"psram_present\":")); out.print((int)psramFound());
-  if (psramFound()) { out.print(F(",\"psram_free\":")); out.print((uint32_t)ESP.getFreePsram()); }
+  j.field(F("psram_present"), psramFound());
+  if (psramFound()) j.field(F("psram_free"), (uint32_t)ESP.getFreePsram());
 #else
-  out.print(F(",\"psram_present\":false"));
+  j.field(F("psram_present"), false);
 #endif
-  out.print(F(",\"cpu_load\":["));
-  out.print(l0,1); out.print(','); out.print(l1,1);
-  out.print(F("],\"cpu_age_ms\":")); out.print(age);
-  out.print(F("}"));
+  j.beginArray(F("cpu_load")).value(l0, 1).value(l1, 1).endArray();
+  j.field(F("cpu_age_ms"), age);
+  j.field(F("cpu_status"), idleLoadStatus());
+  for (const InfoSection& s : s_sections) {
+    if (!s.key || !s.writer) continue;
+    j.key(s.key);
+    s.writer(j.raw());
+  }
+  j.endObject();
+}
+
+void writeJsonTasks(Print& out) {
+  TaskLoad tasks[MAX_TASK_LOADS];
+  uint32_t age = 0;
+  const size_t n = idleLoadTasks(tasks, MAX_TASK_LOADS, &age);
+
+  JsonWriter j(out);
+  j.beginObject();
+  j.field(F("window_ms"), idleLoadWindowMs());
+  j.field(F("age_ms"),    age);
+  j.beginArray(F("tasks"));
+  for (size_t i=0; i<n; ++i) {
+    const TaskLoad& t = tasks[i];
+    j.beginObject();
+    j.field(F("name"),      t.name);
+    j.field(F("core"),      (int)t.core);
+    j.field(F("prio"),      (unsigned)t.prio);
+    j.field(F("stack_min"), (unsigned)t.stackMin);
+    j.field(F("cpu"),       t.pct, 2);
+    j.endObject();
+  }
+  j.endArray();
+  j.endObject();
 }
 
 }} // namespace
@@ -1,8 +1,11 @@
 #pragma once
 #include <Arduino.h>
+#include <functional>
 
 namespace TaskMonitor { namespace detail {
   void writeJsonInfo(Print& out);
+  void addInfoSection(const char* key, std::function<void(Print&)> writer);
+  void writeJsonTasks(Print& out);
 
   // console helpers die door façade gebruikt worden
   void printHeader();
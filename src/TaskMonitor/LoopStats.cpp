@@ -0,0 +1,164 @@
+#include "LoopStats.h"
+#include "IdleLoad.h"
+#include <Json/JsonWriter.h>
+#include <freertos/FreeRTOS.h>
+
+// Latency-histogrammen in HDR-stijl: per octaaf 4 sub-buckets, dus elke
+// bucket is hooguit 25% breed ongeacht de grootte. 0..7 µs is exact; alles
+// vanaf 2^24 µs (~16.8 s) valt in de laatste bucket (max blijft exact).
+// Schrijven gebeurt vanuit de loop-task, lezen vanuit de webserver.
+
+namespace TaskMonitor { namespace detail {
+
+static const uint8_t SUB_BITS = 2;
+static const uint8_t SUBS     = 1 << SUB_BITS;
+static const uint8_t MAX_MAG  = 23;                        // hoogste msb-positie
+static const uint8_t BUCKETS  = (MAX_MAG - SUB_BITS + 2) * SUBS;
+
+struct LoopHist {
+  const char* name;
+  uint32_t count;
+  uint32_t maxUs;
+  uint64_t sumUs;
+  uint32_t bucket[BUCKETS];
+};
+
+static LoopHist     s_hist[MAX_LOOP_STATS];
+static uint8_t      s_histCount = 0;
+static uint32_t     s_sinceMs   = 0;
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static inline uint8_t bucketOf(uint32_t us) {
+  if (us < 2 * SUBS) return (uint8_t)us;
+  uint8_t m = (uint8_t)(31 - __builtin_clz(us));
+  if (m > MAX_MAG) return BUCKETS - 1;
+  const uint8_t sub = (uint8_t)((us >> (m - SUB_BITS)) & (SUBS - 1));
+  return (uint8_t)((m - SUB_BITS + 1) * SUBS + sub);
+}
+
+// Bovengrens (inclusief) van een bucket in µs.
+static uint32_t bucketHigh(uint8_t idx) {
+  if (idx < 2 * SUBS) return idx;
+  const uint8_t m   = (uint8_t)(idx / SUBS + SUB_BITS - 1);
+  const uint8_t sub = (uint8_t)(idx % SUBS);
+  const uint32_t low = (uint32_t)(SUBS + sub) << (m - SUB_BITS);
+  return low + ((1UL << (m - SUB_BITS)) - 1);
+}
+
+static uint32_t percentile(const LoopHist& h, uint16_t permille) {
+  if (!h.count) return 0;
+  const uint32_t rank = (uint32_t)(((uint64_t)h.count * permille + 999) / 1000);
+  uint32_t seen = 0;
+  for (uint8_t i=0; i<BUCKETS; ++i) {
+    seen += h.bucket[i];
+    if (seen >= rank) {
+      const uint32_t hi = bucketHigh(i);
+      return hi < h.maxUs ? hi : h.maxUs;
+    }
+  }
+  return h.maxUs;
+}
+
+// ---------------- public (detail) ----------------
+int8_t loopStatSlot(const char* name) {
+  if (!name) return -1;
+  for (uint8_t i=0; i<s_histCount; ++i) {
+    if (s_hist[i].name == name || strcmp(s_hist[i].name, name) == 0) return (int8_t)i;
+  }
+  portENTER_CRITICAL(&s_mux);
+  int8_t idx = -1;
+  if (s_histCount < MAX_LOOP_STATS) {
+    idx = (int8_t)s_histCount;
+    memset(&s_hist[idx], 0, sizeof(LoopHist));
+    s_hist[idx].name = name;
+    s_histCount++;
+  }
+  if (!s_sinceMs) s_sinceMs = nowMs();
+  portEXIT_CRITICAL(&s_mux);
+  return idx;
+}
+
+void loopStatRecord(int8_t slot, uint32_t us) {
+  if (slot < 0) return;
+  const uint8_t b = bucketOf(us);
+  portENTER_CRITICAL(&s_mux);
+  LoopHist& h = s_hist[slot];
+  h.count++;
+  h.sumUs += us;
+  if (us > h.maxUs) h.maxUs = us;
+  h.bucket[b]++;
+  portEXIT_CRITICAL(&s_mux);
+}
+
+void loopStatsReset() {
+  portENTER_CRITICAL(&s_mux);
+  for (uint8_t i=0; i<s_histCount; ++i) {
+    const char* name = s_hist[i].name;
+    memset(&s_hist[i], 0, sizeof(LoopHist));
+    s_hist[i].name = name;
+  }
+  s_sinceMs = nowMs();
+  portEXIT_CRITICAL(&s_mux);
+}
+
+struct LoopSummary { const char* name; uint32_t count, mean, p50, p90, p99, max; };
+
+static uint8_t summarize(LoopSummary* out) {
+  LoopHist h;
+  portENTER_CRITICAL(&s_mux);
+  const uint8_t n = s_histCount;
+  portEXIT_CRITICAL(&s_mux);
+  for (uint8_t i=0; i<n; ++i) {
+    portENTER_CRITICAL(&s_mux);
+    memcpy(&h, &s_hist[i], sizeof(LoopHist));
+    portEXIT_CRITICAL(&s_mux);
+    LoopSummary& s = out[i];
+    s.name  = h.name;
+    s.count = h.count;
+    s.mean  = h.count ? (uint32_t)(h.sumUs / h.count) : 0;
+    s.p50   = percentile(h, 500);
+    s.p90   = percentile(h, 900);
+    s.p99   = percentile(h, 990);
+    s.max   = h.maxUs;
+  }
+  return n;
+}
+
+void printLoopStats() {
+  LoopSummary sum[MAX_LOOP_STATS];
+  const uint8_t n = summarize(sum);
+  Serial.printf("\n-- Loop latency (us, since %lus) --\n", (unsigned long)(s_sinceMs / 1000UL));
+  Serial.println(F("Name           Count      p50      p90      p99      max"));
+  Serial.println(F("--------------------------------------------------------"));
+  for (uint8_t i=0; i<n; ++i) {
+    Serial.printf("%-12s %7lu %8lu %8lu %8lu %8lu\n", sum[i].name,
+                  (unsigned long)sum[i].count, (unsigned long)sum[i].p50, (unsigned long)sum[i].p90,
+                  (unsigned long)sum[i].p99, (unsigned long)sum[i].max);
+  }
+  Serial.println(F("--------------------------------------------------------"));
+}
+
+void writeJsonLoop(Print& out) {
+  LoopSummary sum[MAX_LOOP_STATS];
+  const uint8_t n = summarize(sum);
+  JsonWriter j(out);
+  j.beginObject();
+  j.field(F("since_ms"), s_sinceMs);
+  j.field(F("unit"), "us");
+  j.beginArray(F("stats"));
+  for (uint8_t i=0; i<n; ++i) {
+    j.beginObject();
+    j.field(F("name"),  sum[i].name);
+    j.field(F("count"), sum[i].count);
+    j.field(F("mean"),  sum[i].mean);
+    j.field(F("p50"),   sum[i].p50);
+    j.field(F("p90"),   sum[i].p90);
+    j.field(F("p99"),   sum[i].p99);
+    j.field(F("max"),   sum[i].max);
+    j.endObject();
+  }
+  j.endArray();
+  j.endObject();
+}
+
+}} // namespace TaskMonitor::detail
@@ -0,0 +1,20 @@
+#pragma once
+#include <Arduino.h>
+
+namespace TaskMonitor { namespace detail {
+  // Max aantal benoemde meetpunten (loop-iteratie + services).
+  static const uint8_t MAX_LOOP_STATS = 8;
+
+  // Slot voor een naam (string literal; vergelijking op pointer, dan op
+  // inhoud). -1 als alle slots bezet zijn.
+  int8_t loopStatSlot(const char* name);
+
+  // Eén meting (µs) toevoegen aan het histogram van slot.
+  void loopStatRecord(int8_t slot, uint32_t us);
+
+  void loopStatsReset();
+
+  // p50/p90/p99/max per meetpunt.
+  void printLoopStats();
+  void writeJsonLoop(Print& out);
+}}
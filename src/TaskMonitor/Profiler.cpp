@@ -0,0 +1,172 @@
+#include "Profiler.h"
+#include "IdleLoad.h"
+#include <esp_heap_caps.h>
+#include <algorithm>
+
+// Statistische PC-profiler, meeliftend op de per-core sampler-ISR. Bij een
+// level-1 interrupt bewaart de xtensa port het onderbroken task-frame op de
+// task-stack en zet pxTopOfStack van de TCB daarop; XT_STK_PC (woord 1) is
+// dan het onderbroken programma-adres. Was er al een andere interrupt actief
+// (nesting > 1) dan is dat frame niet van deze onderbreking: telt als "(isr)".
+//
+// Histogram per core: open-addressing tabel op (task, pc) met hooguit
+// MAX_PROBE stappen in de ISR; wat niet past telt als dropped.
+// Host-kant: scripts/profile_symbolize.py (addr2line -> folded stacks).
+
+extern "C" unsigned port_interruptNesting[portNUM_PROCESSORS];
+
+namespace TaskMonitor { namespace detail {
+
+static const uint32_t PROF_BITS = 9;
+static const uint32_t PROF_SIZE = 1u << PROF_BITS;     // 512 slots per core
+static const uint32_t MAX_PROBE = 16;
+static const uint32_t XT_STK_PC = 1;                    // woord-offset in het exception frame
+
+struct PcSlot { uint32_t pc; void* task; uint32_t count; };
+
+static PcSlot*           s_prof[portNUM_PROCESSORS];
+static volatile bool     s_active[portNUM_PROCESSORS];
+static volatile uint32_t s_left[portNUM_PROCESSORS];
+static volatile uint32_t s_samples[portNUM_PROCESSORS];
+static volatile uint32_t s_lost[portNUM_PROCESSORS];
+static uint32_t          s_rateHz   = 0;
+static uint32_t          s_deadline = 0;      // nowMs() waarna we niet langer wachten
+static bool              s_started  = false;
+static uint32_t          s_owner    = 0;      // id van de meting (en dus van de response die hem leest)
+static uint32_t          s_nextId   = 0;
+
+void IRAM_ATTR profilerSample(uint8_t core, void* tcb) {
+  if (!s_active[core]) return;
+  if (s_left[core] == 0) { s_active[core] = false; return; }
+  s_left[core]--;
+  s_samples[core]++;
+
+  uint32_t pc = 0;
+  if (tcb && port_interruptNesting[core] <= 1) {
+    const uint32_t* frame = *(uint32_t* const*)tcb;     // pxTopOfStack = eerste TCB-veld
+    pc = frame[XT_STK_PC];
+  } else {
+    tcb = nullptr;
+  }
+
+  PcSlot* t = s_prof[core];
+  uint32_t i = ((pc ^ (uint32_t)(uintptr_t)tcb) * 2654435761u) >> (32 - PROF_BITS);
+  for (uint32_t probe=0; probe<MAX_PROBE; ++probe, i=(i+1) & (PROF_SIZE-1)) {
+    if (t[i].count && t[i].pc == pc && t[i].task == tcb) { t[i].count++; return; }
+    if (!t[i].count) { t[i].pc = pc; t[i].task = tcb; t[i].count = 1; return; }
+  }
+  s_lost[core]++;
+}
+
+// ---------------- export ----------------
+struct ProfRead {
+  TaskLoad names[MAX_TASK_LOADS];
+  size_t   nameCount;
+  uint8_t  core;
+  uint32_t slot;
+  bool     header;
+  char     line[64];
+  size_t   lineLen, lineOff;
+};
+static ProfRead* s_read = nullptr;
+
+static void releaseAll() {
+  for (uint8_t c=0; c<portNUM_PROCESSORS; ++c) {
+    s_active[c] = false;
+    free(s_prof[c]);
+    s_prof[c] = nullptr;
+  }
+  delete s_read;
+  s_read = nullptr;
+  s_started = false;
+}
+
+uint32_t profilerStart(uint32_t samplesPerCore, uint32_t rateHz) {
+  // Een meting is van zijn response tot die alles gelezen heeft of is
+  // opgeruimd (profilerRelease); zo corrumpeert een tweede request een
+  // lopende download niet.
+  if (s_started) return 0;
+  for (uint8_t c=0; c<portNUM_PROCESSORS; ++c) {
+    s_prof[c] = (PcSlot*)heap_caps_calloc(PROF_SIZE, sizeof(PcSlot), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!s_prof[c]) { releaseAll(); return 0; }
+    s_samples[c] = 0;
+    s_lost[c]    = 0;
+    s_left[c]    = samplesPerCore;
+  }
+  s_rateHz   = rateHz;
+  s_deadline = nowMs() + (rateHz ? samplesPerCore * 1000UL / rateHz : 0) + 1000UL;
+  s_started  = true;
+  if (++s_nextId == 0) s_nextId = 1;
+  s_owner    = s_nextId;
+  for (uint8_t c=0; c<portNUM_PROCESSORS; ++c) s_active[c] = true;
+  return s_owner;
+}
+
+void profilerRelease(uint32_t id) {
+  if (s_started && id == s_owner) releaseAll();   // al klaar gelezen of nieuwere meting: niets doen
+}
+
+bool profilerReady() {
+  if (!s_started) return false;
+  bool busy = false;
+  for (uint8_t c=0; c<portNUM_PROCESSORS; ++c) busy |= s_active[c] && s_left[c];
+  if (busy && (int32_t)(nowMs() - s_deadline) < 0) return false;
+  for (uint8_t c=0; c<portNUM_PROCESSORS; ++c) s_active[c] = false;   // timer stil? dan stoppen we zelf
+  return true;
+}
+
+static const char* taskName(const ProfRead& r, void* tcb) {
+  if (!tcb) return "(isr)";
+  for (size_t i=0; i<r.nameCount; ++i) if (r.names[i].h == (TaskHandle_t)tcb) return r.names[i].name;
+  return "(exited)";
+}
+
+// Eén regel in s_read->line; false = klaar.
+static bool nextLine(ProfRead& r) {
+  int len = 0;
+  if (!r.header) {
+    uint32_t samples = 0, lost = 0;
+    for (uint8_t c=0; c<portNUM_PROCESSORS; ++c) { samples += s_samples[c]; lost += s_lost[c]; }
+    len = snprintf(r.line, sizeof(r.line), "# tm-profile 1 rate_hz=%lu samples=%lu dropped=%lu\n",
+                   (unsigned long)s_rateHz, (unsigned long)samples, (unsigned long)lost);
+    r.header = true;
+  } else {
+    for (;;) {
+      if (r.core >= portNUM_PROCESSORS) return false;
+      if (r.slot >= PROF_SIZE) { r.core++; r.slot = 0; continue; }
+      const PcSlot& s = s_prof[r.core][r.slot++];
+      if (!s.count) continue;
+      // task <tab> pc <tab> core <tab> count
+      len = snprintf(r.line, sizeof(r.line), "%s\t0x%08lx\t%u\t%lu\n", taskName(r, s.task),
+                     (unsigned long)s.pc, (unsigned)r.core, (unsigned long)s.count);
+      break;
+    }
+  }
+  if (len < 0) return false;
+  r.lineLen = std::min((size_t)len, sizeof(r.line) - 1);
+  r.lineOff = 0;
+  return true;
+}
+
+size_t profilerRead(uint8_t* buf, size_t maxLen) {
+  if (!profilerReady()) return 0;
+  if (!s_read) {
+    s_read = new ProfRead();
+    s_read->nameCount = idleLoadTasks(s_read->names, MAX_TASK_LOADS, nullptr);
+  }
+  ProfRead& r = *s_read;
+  size_t n = 0;
+  while (n < maxLen) {
+    if (r.lineOff == r.lineLen && !nextLine(r)) {
+      if (n == 0) releaseAll();                 // alles verstuurd
+      break;
+    }
+    const size_t take = std::min(maxLen - n, r.lineLen - r.lineOff);
+    memcpy(buf + n, r.line + r.lineOff, take);
+    r.lineOff += take;
+    n += take;
+  }
+  return n;
+}
+
+}} // namespace TaskMonitor::detail
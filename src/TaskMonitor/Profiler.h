@@ -0,0 +1,20 @@
+#pragma once
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+namespace TaskMonitor { namespace detail {
+  // Vanuit de sampler-ISR van `core` (zie Sampler.cpp); tcb = onderbroken task.
+  void profilerSample(uint8_t core, void* tcb);
+
+  // Start een meting van `samples` ticks per core; id > 0, of 0 als er al één
+  // loopt of nog gelezen wordt, of het geheugen (≈6 KB per core) niet
+  // beschikbaar is.
+  uint32_t profilerStart(uint32_t samplesPerCore, uint32_t rateHz);
+  bool profilerReady();
+  // Meting `id` opgeven (response weg, ook bij een afgebroken download).
+  void profilerRelease(uint32_t id);
+
+  // Resultaat als tekst in stukken; 0 = klaar (geheugen wordt vrijgegeven).
+  size_t profilerRead(uint8_t* buf, size_t maxLen);
+}}
@@ -1,115 +1,325 @@
 #include "Sampler.h"
+#include "IdleLoad.h"
+#include "Trace.h"
+#include "Profiler.h"
+#include <Json/JsonWriter.h>
+#include <algorithm>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 
+// Eén sampling-engine in twee lagen:
+//  1) Per core een hardware-timer ISR (1..10 kHz) die de onderbroken task
+//     telt in een hash-tabel van die core. Eén schrijver per tabel (de ISR
+//     van die core), dus geen locks nodig.
+//  2) Een achtergrond-task die per venster de tellers uitleest (delta t.o.v.
+//     vorige keer), de top-N selecteert (nth_element) en die als snapshot in
+//     een dubbele buffer publiceert. Console- en JSON-uitvoer lezen alleen die
+//     snapshot en blokkeren dus nooit (belangrijk voor de async_tcp callbacks).
+// De timers lopen alleen op verzoek (samplerDemand: /sys/active, /events,
+// profiler); daarna valt alles stil, zodat light sleep mogelijk blijft.
+
+// Huidige task per core; ook door de xtensa port (asm) gebruikt. Direct
+// lezen i.p.v. xTaskGetCurrentTaskHandleForCPU: geen critical section in de ISR.
+extern "C" void* volatile pxCurrentTCB[portNUM_PROCESSORS];
+
 namespace TaskMonitor { namespace detail {
 
-struct TaskCount { TaskHandle_t h; uint32_t count; };
-static const size_t MAX_TRACK = 64;
+// ---------------- per-core teller tabel (ISR schrijft) ----------------
+static const uint32_t TABLE_BITS = 6;
+static const uint32_t TABLE_SIZE = 1u << TABLE_BITS;   // 64 slots per core
+
+struct Slot { TaskHandle_t h; volatile uint32_t count; };
+
+static Slot              s_table[portNUM_PROCESSORS][TABLE_SIZE];
+static volatile uint32_t s_ticks[portNUM_PROCESSORS];
+static volatile uint32_t s_dropped[portNUM_PROCESSORS];     // tabel vol
+static volatile bool     s_clearReq[portNUM_PROCESSORS];
+static hw_timer_t*       s_timers[portNUM_PROCESSORS];
+static volatile bool     s_armed = false;
+static uint32_t          s_armedUntil = 0;   // nowMs(); daarna schakelt de publisher de timers uit
 
-static void reset(TaskCount* a){
-  for (size_t i=0;i<MAX_TRACK;i++){ a[i].h=nullptr; a[i].count=0; }
+static inline uint32_t slotOf(TaskHandle_t h){
+  // Fibonacci hashing van het TCB-adres
+  return ((uint32_t)(uintptr_t)h * 2654435761u) >> (32 - TABLE_BITS);
 }
-static void add(TaskCount* a, TaskHandle_t h){
-  if(!h) return;
-  for(size_t i=0;i<MAX_TRACK;i++){
-    if(a[i].h==h){ a[i].count++; return; }
-    if(a[i].h==nullptr){ a[i].h=h; a[i].count=1; return; }
+
+static void IRAM_ATTR recordTick(uint8_t core){
+  Slot* t = s_table[core];
+  if (s_clearReq[core]) {
+    for (uint32_t i=0; i<TABLE_SIZE; ++i) { t[i].h = nullptr; t[i].count = 0; }
+    s_clearReq[core] = false;
   }
-}
-static int cmp(const void* A, const void* B){
-  auto a=(const TaskCount*)A; auto b=(const TaskCount*)B;
-  if(a->count < b->count) return 1;
-  if(a->count > b->count) return -1;
-  return 0;
+  s_ticks[core]++;
+  TaskHandle_t h = (TaskHandle_t)pxCurrentTCB[core];
+  profilerSample(core, h);
+  if (!h) return;
+  uint32_t i = slotOf(h);
+  for (uint32_t probe=0; probe<TABLE_SIZE; ++probe, i=(i+1) & (TABLE_SIZE-1)) {
+    if (t[i].h == h)       { t[i].count++; return; }
+    if (t[i].h == nullptr) { t[i].count = 1; t[i].h = h; return; }
+  }
+  s_dropped[core]++;
 }
 
-void printTasksOnce(uint32_t windowMs, uint32_t stepMs, uint8_t topN){
-  TaskCount counts[MAX_TRACK]; reset(counts);
-  uint32_t samples = windowMs / stepMs; if (!samples) samples = 1;
-  for(uint32_t i=0;i<samples;i++){
-    add(counts, xTaskGetCurrentTaskHandleForCPU(0));
-    add(counts, xTaskGetCurrentTaskHandleForCPU(1));
-    vTaskDelay(pdMS_TO_TICKS(stepMs + ((i%3)==0 ? 1 : 0)));
-  }
-  qsort(counts, MAX_TRACK, sizeof(TaskCount), cmp);
-  const uint32_t total = samples * 2;
+static void IRAM_ATTR onTick0(){ recordTick(0); }
+#if !CONFIG_FREERTOS_UNICORE
+static void IRAM_ATTR onTick1(){ recordTick(1); }
+#endif
 
-  Serial.printf("\n-- Active tasks (sampling %ums @ ~%u–%ums) --\n",
-                (unsigned)windowMs, (unsigned)stepMs, (unsigned)(stepMs+1));
-  Serial.println(F("Name                Core Prio StackMin  Share%"));
-  Serial.println(F("------------------------------------------------"));
+// ---------------- config ----------------
+static uint32_t s_windowMs = 500;
+static uint32_t s_rateHz   = 2000;
+
+// ---------------- publisher task + dubbele buffer ----------------
+struct Cand { TaskHandle_t h; uint32_t count; uint32_t perCore[2]; };
 
-  uint8_t printed = 0;
-  for(size_t i=0; i<MAX_TRACK && counts[i].h && printed<topN; ++i){
-    TaskHandle_t h = counts[i].h;
+static TaskHandle_t   s_task = nullptr;
+static TaskHandle_t   s_prevH[portNUM_PROCESSORS][TABLE_SIZE];   // alleen publisher
+static uint32_t       s_prevC[portNUM_PROCESSORS][TABLE_SIZE];
+static uint32_t       s_prevTicks[portNUM_PROCESSORS];
+static Cand           s_cand[portNUM_PROCESSORS * TABLE_SIZE];
+static TaskLoad       s_names[MAX_TASK_LOADS];
+static ActiveSnapshot s_snap[2];
+static uint8_t        s_front = 0;             // index van de gepubliceerde buffer
+static portMUX_TYPE   s_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// Verzamel delta's van één core in s_cand (samengevoegd per task).
+static size_t collectCore(uint8_t core, size_t n, uint32_t& used){
+  used = 0;
+  for (uint32_t i=0; i<TABLE_SIZE; ++i) {
+    const uint32_t c = s_table[core][i].count;
+    const TaskHandle_t h = s_table[core][i].h;
+    if (!h) continue;
+    used++;
+    const uint32_t d = (h == s_prevH[core][i]) ? (c - s_prevC[core][i]) : c;
+    s_prevH[core][i] = h;
+    s_prevC[core][i] = c;
+    if (!d) continue;
+
+    size_t k = 0;
+    while (k < n && s_cand[k].h != h) ++k;
+    if (k == n) { s_cand[n].h = h; s_cand[n].count = 0; s_cand[n].perCore[0] = s_cand[n].perCore[1] = 0; ++n; }
+    s_cand[k].count += d;
+    s_cand[k].perCore[core] += d;
+  }
+  return n;
+}
+
+static void describe(ActiveTask& t, TaskHandle_t h, size_t nameCount){
+  // Namen/prio/stack uit de run-time snapshot: die bevat alleen levende tasks,
+  // dus geen pcTaskGetName op een mogelijk al verwijderde TCB.
+  for (size_t i=0; i<nameCount; ++i) {
+    if (s_names[i].h != h) continue;
+    memcpy(t.name, s_names[i].name, sizeof(t.name));
+    t.prio     = s_names[i].prio;
+    t.stackMin = s_names[i].stackMin;
+    return;
+  }
+  if (nameCount == 0) {                       // geen run-time stats beschikbaar
     const char* name = pcTaskGetName(h);
-    UBaseType_t prio = uxTaskPriorityGet(h);
+    strncpy(t.name, name ? name : "(null)", sizeof(t.name) - 1);
+    t.name[sizeof(t.name) - 1] = '\0';
+    t.prio = (uint8_t)uxTaskPriorityGet(h);
 #if (INCLUDE_uxTaskGetStackHighWaterMark == 1)
-    UBaseType_t stackMin = uxTaskGetStackHighWaterMark(h);
+    t.stackMin = (uint16_t)uxTaskGetStackHighWaterMark(h);
 #else
-    UBaseType_t stackMin = 0;
+    t.stackMin = 0;
 #endif
-    int core = -1;
-    TaskHandle_t c0 = xTaskGetCurrentTaskHandleForCPU(0);
-    TaskHandle_t c1 = xTaskGetCurrentTaskHandleForCPU(1);
-    if (h==c0) core=0; else if (h==c1) core=1;
+    return;
+  }
+  strcpy(t.name, "(exited)");
+  t.prio = 0; t.stackMin = 0;
+}
 
-    const float pct = total? (100.f*(float)counts[i].count/(float)total) : 0.f;
-    Serial.printf("%-18s %4s %4u %8u %7.2f%%\n",
-      (name ? name : "(null)"),
-      (core==0?"0": core==1?"1":"?"),
-      (unsigned)prio,
-      (unsigned)stackMin,
-      pct
-    );
-    printed++;
+// Lees één venster uit en vul de (back) snapshot.
+static void publishWindow(ActiveSnapshot& snap){
+  size_t n = 0;
+  uint32_t total = 0, dropped = 0;
+  bool clear = false;
+  for (uint8_t core=0; core<portNUM_PROCESSORS; ++core) {
+    const uint32_t ticks = s_ticks[core];
+    total += ticks - s_prevTicks[core];
+    s_prevTicks[core] = ticks;
+    uint32_t used = 0;
+    n = collectCore(core, n, used);
+    dropped += s_dropped[core];
+    // Opruimen als de tabel volloopt met (verdwenen) tasks
+    if (used > (TABLE_SIZE * 3) / 4) clear = true;
+  }
+  if (clear) {
+    for (uint8_t core=0; core<portNUM_PROCESSORS; ++core) {
+      memset(s_prevH[core], 0, sizeof(s_prevH[core]));
+      memset(s_prevC[core], 0, sizeof(s_prevC[core]));
+      s_clearReq[core] = true;
+    }
+  }
+
+  // Partiële selectie: alleen de top-N wordt echt gesorteerd.
+  const size_t top = std::min<size_t>(n, ACTIVE_TOP_MAX);
+  auto byCount = [](const Cand& a, const Cand& b){ return a.count > b.count; };
+  if (top < n) std::nth_element(s_cand, s_cand + top, s_cand + n, byCount);
+  std::sort(s_cand, s_cand + top, byCount);
+
+  const size_t nameCount = idleLoadTasks(s_names, MAX_TASK_LOADS, nullptr);
+
+  snap.windowMs     = s_windowMs;
+  snap.rateHz       = s_rateHz;
+  snap.totalSamples = total;
+  snap.dropped      = dropped;
+  snap.count        = (uint8_t)top;
+  for (size_t i=0; i<top; ++i) {
+    const Cand& c = s_cand[i];
+    ActiveTask& t = snap.tasks[i];
+    describe(t, c.h, nameCount);
+    t.core  = (c.perCore[0] && !c.perCore[1]) ? 0 : (c.perCore[1] && !c.perCore[0]) ? 1 : -1;
+    t.share = total ? (100.f*(float)c.count/(float)total) : 0.f;
+  }
+  snap.stampMs = nowMs();
+}
+
+// Alleen de publisher task zet de timers aan/uit. De beslissing (s_armed)
+// valt altijd onder s_mux, zodat samplerDemand() nooit een wakeup mist.
+static void setTimers(bool on){
+  for (uint8_t core=0; core<portNUM_PROCESSORS; ++core) {
+    if (!s_timers[core]) continue;
+    if (on) timerAlarmEnable(s_timers[core]); else timerAlarmDisable(s_timers[core]);
   }
-  Serial.println(F("------------------------------------------------"));
 }
 
-void writeJsonActive(Print& out, uint32_t windowMs, uint32_t stepMs, uint8_t topN){
-  TaskCount counts[MAX_TRACK]; reset(counts);
-  uint32_t samples = windowMs / stepMs; if (!samples) samples = 1;
-  for(uint32_t i=0;i<samples;i++){
-    add(counts, xTaskGetCurrentTaskHandleForCPU(0));
-    add(counts, xTaskGetCurrentTaskHandleForCPU(1));
-    vTaskDelay(pdMS_TO_TICKS(stepMs + ((i%3)==0 ? 1 : 0)));
+static void SamplerTask(void*){
+  TickType_t last = xTaskGetTickCount();
+  for(;;){
+    if (!s_armed) {                       // geen vraag: slapen tot samplerDemand()
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      portENTER_CRITICAL(&s_mux);
+      s_armed = true;
+      portEXIT_CRITICAL(&s_mux);
+      setTimers(true);
+      last = xTaskGetTickCount();
+    }
+    vTaskDelayUntil(&last, pdMS_TO_TICKS(s_windowMs));
+    TRACE_SCOPE("sampler.publish");
+    const uint8_t back = s_front ^ 1;   // alleen deze task schrijft in de back buffer
+    publishWindow(s_snap[back]);
+    portENTER_CRITICAL(&s_mux);
+    s_front = back;
+    const bool expired = (int32_t)(nowMs() - s_armedUntil) >= 0;
+    if (expired) s_armed = false;        // vraag hierna ziet !s_armed en notificeert
+    portEXIT_CRITICAL(&s_mux);
+    if (expired) setTimers(false);       // een notify uit de tussentijd blijft staan
   }
-  qsort(counts, MAX_TRACK, sizeof(TaskCount), cmp);
-  const uint32_t total = samples * 2;
+}
 
-  out.print(F("{\"window_ms\":")); out.print(windowMs);
-  out.print(F(",\"step_ms\":"));  out.print(stepMs);
-  out.print(F(",\"total_samples\":")); out.print(total);
-  out.print(F(",\"tasks\":["));
+// ---------------- timer setup (interrupt op de juiste core) ----------------
+struct TickSetup { uint8_t core; uint8_t timer; TaskHandle_t waiter; };
 
-  uint8_t printed=0;
-  for(size_t i=0; i<MAX_TRACK && counts[i].h && printed<topN; ++i){
-    TaskHandle_t h = counts[i].h;
-    const char* name = pcTaskGetName(h);
-    UBaseType_t prio = uxTaskPriorityGet(h);
-#if (INCLUDE_uxTaskGetStackHighWaterMark == 1)
-    UBaseType_t stackMin = uxTaskGetStackHighWaterMark(h);
+static void TickSetupTask(void* arg){
+  // Draait gepind op de doelcore: de interrupt wordt op de aanroepende core gealloceerd.
+  TickSetup* s = (TickSetup*)arg;
+  hw_timer_t* t = timerBegin(s->timer, 80, true);   // 80 MHz APB / 80 = 1 MHz
+#if !CONFIG_FREERTOS_UNICORE
+  timerAttachInterrupt(t, s->core ? &onTick1 : &onTick0, true);
 #else
-    UBaseType_t stackMin = 0;
+  timerAttachInterrupt(t, &onTick0, true);
 #endif
-    int core = -1;
-    TaskHandle_t c0 = xTaskGetCurrentTaskHandleForCPU(0);
-    TaskHandle_t c1 = xTaskGetCurrentTaskHandleForCPU(1);
-    if (h==c0) core=0; else if (h==c1) core=1;
-
-    const float share = total? (100.f*(float)counts[i].count/(float)total) : 0.f;
-
-    if(printed++) out.print(',');
-    out.print(F("{\"name\":\"")); out.print(name?name:"(null)");
-    out.print(F("\",\"core\":")); out.print(core);
-    out.print(F(",\"prio\":"));   out.print((unsigned)prio);
-    out.print(F(",\"stack_min\":")); out.print((unsigned)stackMin);
-    out.print(F(",\"share\":"));  out.print(share,2);
-    out.print('}');
+  timerAlarmWrite(t, 1000000UL / s_rateHz, true);   // alarm pas aan via samplerDemand()
+  s_timers[s->core] = t;
+  xTaskNotifyGive(s->waiter);
+  vTaskDelete(nullptr);
+}
+
+// ---------------- public (detail) ----------------
+void samplerBegin(uint32_t windowMs, uint32_t rateHz, int8_t timerBase){
+  s_windowMs = windowMs ? windowMs : 500;
+  s_rateHz   = std::min<uint32_t>(std::max<uint32_t>(rateHz, 1000), 10000);
+  if (s_task) return;
+  memset(s_snap, 0, sizeof(s_snap));
+  if (timerBase < 0 || timerBase + portNUM_PROCESSORS > 4) {
+    Serial.println(F("[SYS] TaskSampler disabled (no hardware timer)"));
+    return;
+  }
+
+  for (uint8_t core=0; core<portNUM_PROCESSORS; ++core) {
+    TickSetup setup{core, (uint8_t)(timerBase + core), xTaskGetCurrentTaskHandle()};
+    xTaskCreatePinnedToCore(TickSetupTask, "TickSetup", 2048, &setup, configMAX_PRIORITIES - 1, nullptr, core);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+  }
+
+  const UBaseType_t prio = tskIDLE_PRIORITY + 1; // net boven idle
+  xTaskCreate(SamplerTask, "TaskSampler", 2560, nullptr, prio, &s_task);
+  Serial.printf("[SYS] TaskSampler ready (timers %d..%d, window=%ums, rate=%uHz, on demand)\n",
+                timerBase, timerBase + portNUM_PROCESSORS - 1, s_windowMs, s_rateHz);
+}
+
+void samplerDemand(uint32_t holdMs){
+  if (!s_task) return;
+  const uint32_t until = nowMs() + holdMs;
+  portENTER_CRITICAL(&s_mux);
+  const bool wake = !s_armed;
+  if (wake || (int32_t)(until - s_armedUntil) > 0) s_armedUntil = until;
+  portEXIT_CRITICAL(&s_mux);
+  if (wake) xTaskNotifyGive(s_task);
+}
+
+uint32_t samplerRateHz(){ return s_task ? s_rateHz : 0; }
+
+bool samplerLatest(ActiveSnapshot& out){
+  portENTER_CRITICAL(&s_mux);
+  out = s_snap[s_front];
+  portEXIT_CRITICAL(&s_mux);
+  return out.stampMs != 0;
+}
+
+void printTasksOnce(uint8_t topN){
+  samplerDemand(SAMPLER_HOLD_MS);
+  ActiveSnapshot snap;
+  if (!samplerLatest(snap)) { Serial.println(F("\n-- Active tasks: no snapshot yet --")); return; }
+
+  Serial.printf("\n-- Active tasks (sampling %ums @ %uHz, age %lums) --\n",
+                (unsigned)snap.windowMs, (unsigned)snap.rateHz,
+                (unsigned long)(nowMs() - snap.stampMs));
+  Serial.println(F("Name                Core Prio StackMin  Share%"));
+  Serial.println(F("------------------------------------------------"));
+
+  for(uint8_t i=0; i<snap.count && i<topN; ++i){
+    const ActiveTask& t = snap.tasks[i];
+    Serial.printf("%-18s %4s %4u %8u %7.2f%%\n",
+      t.name,
+      (t.core==0?"0": t.core==1?"1":"?"),
+      (unsigned)t.prio,
+      (unsigned)t.stackMin,
+      t.share
+    );
+  }
+  Serial.println(F("------------------------------------------------"));
+}
+
+void writeJsonActive(Print& out, uint8_t topN){
+  samplerDemand(SAMPLER_HOLD_MS);       // eerste vraag na stilte: oude snapshot, daarna vers
+  ActiveSnapshot snap;
+  const bool have = samplerLatest(snap);
+
+  JsonWriter j(out);
+  j.beginObject();
+  j.field(F("sampling"),      (bool)s_armed);
+  j.field(F("window_ms"),     snap.windowMs);
+  j.field(F("rate_hz"),       snap.rateHz);
+  j.field(F("total_samples"), snap.totalSamples);
+  j.field(F("dropped"),       snap.dropped);
+  if (have) j.field(F("age_ms"), nowMs() - snap.stampMs); else j.fieldNull(F("age_ms"));
+  j.beginArray(F("tasks"));
+  for(uint8_t i=0; i<snap.count && i<topN; ++i){
+    const ActiveTask& t = snap.tasks[i];
+    j.beginObject();
+    j.field(F("name"),      t.name);
+    j.field(F("core"),      (int)t.core);
+    j.field(F("prio"),      (unsigned)t.prio);
+    j.field(F("stack_min"), (unsigned)t.stackMin);
+    j.field(F("share"),     t.share, 2);
+    j.endObject();
   }
-  out.print(F("]}"));
+  j.endArray();
+  j.endObject();
 }
 
 }} // namespace TaskMonitor::detail
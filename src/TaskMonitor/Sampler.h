@@ -1,10 +1,50 @@
 #pragma once
 #include <Arduino.h>
+#include <freertos/FreeRTOS.h>
 
 namespace TaskMonitor { namespace detail {
-  // Console print van “active tasks” lijst (blokkerend voor windowMs)
-  void printTasksOnce(uint32_t windowMs, uint32_t stepMs, uint8_t topN);
+  // Max aantal tasks in een gepubliceerde top-N snapshot.
+  static const uint8_t ACTIVE_TOP_MAX = 16;
 
-  // JSON uitstoot voor “active tasks”
-  void writeJsonActive(Print& out, uint32_t windowMs, uint32_t stepMs, uint8_t topN);
+  struct ActiveTask {
+    char     name[configMAX_TASK_NAME_LEN];
+    int8_t   core;       // 0/1, of -1 als de task op beide cores gezien is
+    uint8_t  prio;
+    uint16_t stackMin;
+    float    share;      // % van alle samples (beide cores)
+  };
+
+  struct ActiveSnapshot {
+    uint32_t   stampMs;  // 0 = nog geen snapshot
+    uint32_t   windowMs;
+    uint32_t   rateHz;   // ISR sample-frequentie per core
+    uint32_t   totalSamples;
+    uint32_t   dropped;  // samples die niet in de hash-tabel pasten (cumulatief)
+    uint8_t    count;
+    ActiveTask tasks[ACTIVE_TOP_MAX];
+  };
+
+  // Zolang houdt een vraag (samplerDemand) de timers aan.
+  static const uint32_t SAMPLER_HOLD_MS = 10000;
+
+  // Reserveert hw timers timerBase (core0) en timerBase+1 (core1) voor de
+  // per-core ISR's (rateHz, 1000..10000) en start de publisher task. De ISR's
+  // lopen pas na samplerDemand(); timerBase < 0 = sampler uit.
+  void samplerBegin(uint32_t windowMs, uint32_t rateHz, int8_t timerBase);
+
+  // Timers (weer) aanzetten voor minstens holdMs; daarna vallen ze vanzelf
+  // stil. Aangeroepen door de lezers van de snapshot en de profiler.
+  void samplerDemand(uint32_t holdMs);
+
+  // ISR sample-frequentie per core; 0 als de sampler niet draait.
+  uint32_t samplerRateHz();
+
+  // Kopie van de laatst gepubliceerde snapshot; false als er nog geen is.
+  bool samplerLatest(ActiveSnapshot& out);
+
+  // Console print van “active tasks” lijst (laatste snapshot, niet blokkerend)
+  void printTasksOnce(uint8_t topN);
+
+  // JSON uitstoot voor “active tasks” (laatste snapshot, niet blokkerend)
+  void writeJsonActive(Print& out, uint8_t topN);
 }}
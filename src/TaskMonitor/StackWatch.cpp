@@ -0,0 +1,230 @@
+#include "StackWatch.h"
+#include "IdleLoad.h"
+#include <Json/JsonWriter.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// Stack-headroom van alle tasks: een esp_timer loopt periodiek
+// uxTaskGetSystemState af en houdt per task de laagste high-water-mark vast
+// (ESP-IDF: in bytes). Tasks die verdwijnen blijven in de tabel staan, zodat
+// ook kortlevende tasks te dimensioneren zijn. Meldingen worden in de
+// callback alleen klaargezet; loggen (flash) gebeurt vanuit loop().
+// De statusbuffer groeit mee met uxTaskGetNumberOfTasks(); lukt dat niet,
+// dan pauzeert de scan zichtbaar (status "paused") i.p.v. stil te stoppen.
+
+namespace TaskMonitor { namespace detail {
+
+static const uint8_t MAX_WATCH = 32;
+static const uint8_t ALERT_RING = 8;
+static const uint8_t STATUS_HEADROOM = 8;        // marge voor tasks die erbij komen
+
+struct StackRec {
+  TaskHandle_t h;
+  char     name[configMAX_TASK_NAME_LEN];
+  uint32_t minFree;       // bytes
+  uint32_t lowMs;         // uptime van de laagste meting
+  bool     alive;
+  bool     alerted;
+};
+
+struct StackAlert { char name[configMAX_TASK_NAME_LEN]; uint32_t headroom; };
+
+static StackRec     s_recs[MAX_WATCH];
+static uint8_t      s_recCount = 0;
+static StackAlert   s_alerts[ALERT_RING];
+static uint8_t      s_alertHead = 0, s_alertCount = 0;
+static uint32_t     s_threshold = 512;
+static uint32_t     s_periodMs  = 2000;
+static uint32_t     s_scans     = 0;
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t s_timer = nullptr;
+static std::function<void(const char*, uint32_t)> s_onLow;
+static volatile bool s_paused   = false;         // laatste scan mislukt (geen geheugen)
+static bool         s_pausedLog = false;         // gemelde toestand (loop-kant)
+static uint16_t     s_untracked = 0;             // levende tasks zonder plek in s_recs
+
+#if (configUSE_TRACE_FACILITY == 1)
+static TaskStatus_t* s_status    = nullptr;     // alleen gebruikt vanuit scanOnce()
+static UBaseType_t   s_statusCap = 0;
+
+// Buffer op het huidige aantal tasks + marge; false = malloc mislukt.
+static bool ensureStatus() {
+  const UBaseType_t want = uxTaskGetNumberOfTasks() + STATUS_HEADROOM;
+  if (want <= s_statusCap) return true;
+  TaskStatus_t* p = (TaskStatus_t*)malloc(want * sizeof(TaskStatus_t));
+  if (!p) return false;
+  free(s_status);
+  s_status    = p;
+  s_statusCap = want;
+  return true;
+}
+
+static StackRec* recordFor(const TaskStatus_t& st) {
+  StackRec* dead = nullptr;
+  for (uint8_t i=0; i<s_recCount; ++i) {
+    if (s_recs[i].h == st.xHandle) return &s_recs[i];
+    if (!dead && !s_recs[i].alive) dead = &s_recs[i];
+  }
+  StackRec* r = (s_recCount < MAX_WATCH) ? &s_recs[s_recCount++] : dead;
+  if (!r) return nullptr;                        // tabel vol met levende tasks
+  r->h       = st.xHandle;
+  strncpy(r->name, st.pcTaskName ? st.pcTaskName : "(null)", sizeof(r->name) - 1);
+  r->name[sizeof(r->name) - 1] = '\0';
+  r->minFree = UINT32_MAX;
+  r->alerted = false;
+  return r;
+}
+
+static void scanOnce(void*) {
+  const UBaseType_t n = ensureStatus() ? uxTaskGetSystemState(s_status, s_statusCap, nullptr) : 0;
+  s_paused = (n == 0);                           // volgende scan probeert opnieuw
+  if (n == 0) return;
+  const uint32_t now = nowMs();
+  uint16_t untracked = 0;
+
+  portENTER_CRITICAL(&s_mux);
+  for (uint8_t i=0; i<s_recCount; ++i) s_recs[i].alive = false;
+  for (UBaseType_t i=0; i<n; ++i) {
+    StackRec* r = recordFor(s_status[i]);
+    if (!r) { untracked++; continue; }
+    r->alive = true;
+    const uint32_t hw = (uint32_t)s_status[i].usStackHighWaterMark;
+    if (hw < r->minFree) { r->minFree = hw; r->lowMs = now; }
+    if (!r->alerted && r->minFree < s_threshold) {
+      r->alerted = true;
+      StackAlert& a = s_alerts[(s_alertHead + s_alertCount) % ALERT_RING];
+      memcpy(a.name, r->name, sizeof(a.name));
+      a.headroom = r->minFree;
+      if (s_alertCount < ALERT_RING) s_alertCount++;
+      else s_alertHead = (uint8_t)((s_alertHead + 1) % ALERT_RING);   // oudste overschrijven
+    }
+  }
+  s_untracked = untracked;
+  s_scans++;
+  portEXIT_CRITICAL(&s_mux);
+}
+#endif
+
+// ---------------- public (detail) ----------------
+void stackWatchBegin(uint32_t periodMs, uint32_t thresholdBytes) {
+  s_periodMs  = periodMs ? periodMs : 2000;
+  s_threshold = thresholdBytes;
+  if (s_timer) return;
+
+#if (configUSE_TRACE_FACILITY == 1)
+  esp_timer_create_args_t args = {};
+  args.callback = &scanOnce;
+  args.name     = "tm_stacks";
+  if (esp_timer_create(&args, &s_timer) != ESP_OK) {
+    s_timer = nullptr;
+    Serial.println(F("[SYS] Stack watch timer create FAILED"));
+    return;
+  }
+  esp_timer_start_periodic(s_timer, (uint64_t)s_periodMs * 1000ULL);
+  Serial.printf("[SYS] Stack watch started (period=%ums, threshold=%uB)\n",
+                (unsigned)s_periodMs, (unsigned)s_threshold);
+#else
+  Serial.println(F("[SYS] Stack watch unavailable (configUSE_TRACE_FACILITY disabled)"));
+#endif
+}
+
+void stackWatchSetThreshold(uint32_t thresholdBytes) {
+  portENTER_CRITICAL(&s_mux);
+  s_threshold = thresholdBytes;
+  for (uint8_t i=0; i<s_recCount; ++i) s_recs[i].alerted = false;   // opnieuw beoordelen
+  portEXIT_CRITICAL(&s_mux);
+}
+
+void stackWatchOnLow(std::function<void(const char*, uint32_t)> cb) {
+  s_onLow = cb;
+}
+
+void stackWatchDispatch() {
+  const bool paused = s_paused;
+  if (paused != s_pausedLog) {                   // één melding per overgang
+    s_pausedLog = paused;
+    if (paused) Serial.printf("[TASK] Stack watch paused: no buffer for %u tasks\n",
+                              (unsigned)uxTaskGetNumberOfTasks());
+    else        Serial.println(F("[TASK] Stack watch resumed"));
+  }
+  for (;;) {
+    StackAlert a;
+    portENTER_CRITICAL(&s_mux);
+    if (!s_alertCount) { portEXIT_CRITICAL(&s_mux); return; }
+    a = s_alerts[s_alertHead];
+    s_alertHead = (uint8_t)((s_alertHead + 1) % ALERT_RING);
+    s_alertCount--;
+    portEXIT_CRITICAL(&s_mux);
+
+    Serial.printf("[TASK] Low stack: %s headroom=%uB\n", a.name, (unsigned)a.headroom);
+    if (s_onLow) s_onLow(a.name, a.headroom);
+  }
+}
+
+// Kopie van de tabel, laagste headroom eerst.
+static uint8_t copySorted(StackRec* out, uint32_t& threshold, uint32_t& scans, uint16_t& untracked) {
+  portENTER_CRITICAL(&s_mux);
+  const uint8_t n = s_recCount;
+  memcpy(out, s_recs, n * sizeof(StackRec));
+  threshold = s_threshold;
+  scans     = s_scans;
+  untracked = s_untracked;
+  portEXIT_CRITICAL(&s_mux);
+
+  for (uint8_t i=1; i<n; ++i) {
+    StackRec key = out[i];
+    uint8_t j = i;
+    while (j > 0 && out[j-1].minFree > key.minFree) { out[j] = out[j-1]; --j; }
+    out[j] = key;
+  }
+  return n;
+}
+
+void printStacks() {
+  StackRec recs[MAX_WATCH];
+  uint32_t threshold = 0, scans = 0;
+  uint16_t untracked = 0;
+  const uint8_t n = copySorted(recs, threshold, scans, untracked);
+
+  Serial.printf("\n-- Stack headroom (min since boot, %lu scans, alert <%luB) --\n",
+                (unsigned long)scans, (unsigned long)threshold);
+  if (s_paused)  Serial.println(F("!! scan paused: no memory for the task list"));
+  if (untracked) Serial.printf("!! %u tasks not tracked (table full, MAX_WATCH=%u)\n",
+                               (unsigned)untracked, (unsigned)MAX_WATCH);
+  Serial.println(F("Name                MinFree  Alive"));
+  Serial.println(F("-----------------------------------"));
+  for (uint8_t i=0; i<n; ++i) {
+    Serial.printf("%-18s %9lu  %5s%s\n", recs[i].name, (unsigned long)recs[i].minFree,
+                  recs[i].alive ? "yes" : "no", recs[i].minFree < threshold ? "  LOW" : "");
+  }
+  Serial.println(F("-----------------------------------"));
+}
+
+void writeJsonStacks(Print& out) {
+  StackRec recs[MAX_WATCH];
+  uint32_t threshold = 0, scans = 0;
+  uint16_t untracked = 0;
+  const uint8_t n = copySorted(recs, threshold, scans, untracked);
+
+  JsonWriter j(out);
+  j.beginObject();
+  j.field(F("period_ms"), s_periodMs);
+  j.field(F("threshold"), threshold);
+  j.field(F("scans"),     scans);
+  j.field(F("status"),    s_paused ? "paused" : "ok");
+  j.field(F("untracked"), (uint32_t)untracked);
+  j.beginArray(F("tasks"));
+  for (uint8_t i=0; i<n; ++i) {
+    j.beginObject();
+    j.field(F("name"),     recs[i].name);
+    j.field(F("min_free"), recs[i].minFree);
+    j.field(F("low_ms"),   recs[i].lowMs);
+    j.field(F("alive"),    recs[i].alive);
+    j.endObject();
+  }
+  j.endArray();
+  j.endObject();
+}
+
+}} // namespace TaskMonitor::detail
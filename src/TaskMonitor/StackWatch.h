@@ -0,0 +1,19 @@
+#pragma once
+#include <Arduino.h>
+#include <functional>
+
+namespace TaskMonitor { namespace detail {
+  // Start de periodieke stack-scan (esp_timer, periodMs) over alle tasks.
+  // Een task die onder thresholdBytes headroom komt wordt één keer gemeld.
+  void stackWatchBegin(uint32_t periodMs, uint32_t thresholdBytes);
+
+  void stackWatchSetThreshold(uint32_t thresholdBytes);
+  void stackWatchOnLow(std::function<void(const char* task, uint32_t headroom)> cb);
+
+  // Meldingen afleveren vanuit een gewone task (TaskMonitor::loop()).
+  void stackWatchDispatch();
+
+  // Console/JSON: laagste headroom per task sinds boot.
+  void printStacks();
+  void writeJsonStacks(Print& out);
+}}
@@ -2,23 +2,37 @@
 #include "IdleLoad.h"
 #include "Sampler.h"
 #include "JsonOut.h"
+#include "History.h"
+#include "HeapProfile.h"
+#include "StackWatch.h"
+#include "LoopStats.h"
+#include "Profiler.h"
+#include <esp_timer.h>
 
 namespace TaskMonitor {
 
-void begin(uint32_t sampleMs) {
-  detail::idleLoadBegin(sampleMs, /*measureWindowMs=*/500);
+void begin(uint32_t sampleMs, int8_t samplerTimer) {
+  detail::idleLoadBegin(sampleMs);
+  detail::samplerBegin(/*windowMs=*/500, /*rateHz=*/2000, samplerTimer);
+  detail::historyBegin();
+  detail::heapProfileBegin();
+  detail::stackWatchBegin(/*periodMs=*/2000, /*thresholdBytes=*/512);
 }
 
 void printOnce(bool includeTasks) {
   detail::printHeader();
   detail::printCpu();
-  if (includeTasks) detail::printTasksOnce(/*windowMs=*/500, /*stepMs=*/1, /*topN=*/12);
+  if (includeTasks) detail::printTaskLoads();
+  if (includeTasks) detail::printTasksOnce(/*topN=*/12);
+  if (includeTasks) detail::printStacks();
+  if (includeTasks) detail::printLoopStats();
   detail::printFooter();
 }
 
 void loop(uint32_t printEveryMs) {
   // load loopt in een eigen task; hier alleen optioneel print pacing
   static uint32_t lastPrint = 0;
+  detail::stackWatchDispatch();
   if (!printEveryMs) return;
   uint32_t now = detail::nowMs();
   if ((uint32_t)(now - lastPrint) >= printEveryMs) {
@@ -41,8 +55,86 @@ void writeJsonInfo(Print& out) {
   detail::writeJsonInfo(out);
 }
 
-void writeJsonActive(Print& out, uint32_t windowMs, uint32_t stepMs, uint8_t topN) {
-  detail::writeJsonActive(out, windowMs, stepMs, topN);
+void addInfoSection(const char* key, std::function<void(Print&)> writer) {
+  detail::addInfoSection(key, writer);
+}
+
+void writeJsonTasks(Print& out) {
+  detail::writeJsonTasks(out);
+}
+
+void writeJsonActive(Print& out, uint8_t topN) {
+  detail::writeJsonActive(out, topN);
+}
+
+bool writeHistory(Print& out, const char* metric, const char* tier, bool binary) {
+  detail::HistMetric m; detail::HistTier t;
+  if (!detail::historyMetric(metric, m) || !detail::historyTier(tier, t)) return false;
+  if (binary) detail::writeBinHistory(out, m, t);
+  else        detail::writeJsonHistory(out, m, t);
+  return true;
+}
+
+void writeJsonHeap(Print& out) {
+  detail::writeJsonHeap(out);
+}
+
+void writeJsonStacks(Print& out) {
+  detail::writeJsonStacks(out);
+}
+
+void onStackLow(std::function<void(const char*, uint32_t)> cb, uint32_t thresholdBytes) {
+  detail::stackWatchSetThreshold(thresholdBytes);
+  detail::stackWatchOnLow(cb);
+}
+
+void writeJsonLoop(Print& out) {
+  detail::writeJsonLoop(out);
+}
+
+void resetLoopStats() {
+  detail::loopStatsReset();
+}
+
+LoopScope::LoopScope(const char* name) {
+  _slot    = detail::loopStatSlot(name);
+  _startUs = (uint32_t)esp_timer_get_time();
+}
+
+LoopScope::~LoopScope() {
+  detail::loopStatRecord(_slot, (uint32_t)esp_timer_get_time() - _startUs);
+}
+
+uint32_t profileStart(uint32_t ms) {
+  const uint32_t rate = detail::samplerRateHz();
+  if (!rate) return 0;
+  const uint32_t id = detail::profilerStart((uint32_t)((uint64_t)ms * rate / 1000ULL), rate);
+  if (id) detail::samplerDemand(ms + 1000);     // profiler rijdt mee op de sampler-ISR's
+  return id;
+}
+
+bool profileReady() {
+  return detail::profilerReady();
+}
+
+void profileRelease(uint32_t id) {
+  detail::profilerRelease(id);
+}
+
+size_t profileRead(uint8_t* buf, size_t maxLen) {
+  return detail::profilerRead(buf, maxLen);
+}
+
+bool heapTrace(bool on) {
+  return on ? detail::heapTraceStart() : detail::heapTraceStop();
+}
+
+HeapRouteScope::HeapRouteScope(const char* route) {
+  _idx = detail::heapRouteEnter(route, _freeBefore);
+}
+
+HeapRouteScope::~HeapRouteScope() {
+  detail::heapRouteLeave(_idx, _freeBefore);
 }
 
 } // namespace TaskMonitor
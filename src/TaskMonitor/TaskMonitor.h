@@ -1,14 +1,23 @@
 #pragma once
 #include <Arduino.h>
+#include <functional>
+
+#ifndef TM_SAMPLER_TIMER_BASE
+  #define TM_SAMPLER_TIMER_BASE 2   // hw timers 2 (core0) en 3 (core1); 0/1 blijven vrij voor de sketch
+#endif
 
 namespace TaskMonitor {
-  // Start de monitor. sampleMs = calibratie-venster (ms) voor idle-baseline.
-  void begin(uint32_t sampleMs = 250);
+  // Start de monitor. sampleMs = meetvenster (ms) van de run-time accounting.
+  // Start ook de achtergrond-sampler voor de "active tasks" snapshot (op hw
+  // timers samplerTimer en samplerTimer+1, alleen actief op verzoek; -1 = uit),
+  // de 1 s history sampler en de stack-headroom scan.
+  void begin(uint32_t sampleMs = 500, int8_t samplerTimer = TM_SAMPLER_TIMER_BASE);
 
   // Eén snapshot printen (CPU load, heap/psram, uptime, optioneel tasklist).
   void printOnce(bool includeTasks = false);
 
-  // Periodieke service-call; mag je zo vaak als je wilt aanroepen.
+  // Periodieke service-call; mag je zo vaak als je wilt aanroepen. Levert ook
+  // de stack-meldingen af (zie onStackLow).
   // printEveryMs > 0 => ook elke N ms printen; 0 => geen consoleprint (load loopt nu in eigen task).
   void loop(uint32_t printEveryMs = 0);
 
@@ -16,11 +25,80 @@ namespace TaskMonitor {
   void getCpuLoad(float &core0, float &core1);
 
   // Gecachte load + leeftijd van de meting (ms) in ageMs (optioneel).
+  // NAN als CPU-load niet beschikbaar is (zie "cpu_status" in writeJsonInfo).
   void getCpuLoadCached(float &core0, float &core1, uint32_t* ageMs = nullptr);
 
   // Systeeminfo + gecachte CPU-load als JSON naar een Print (bv. AsyncResponseStream).
   void writeJsonInfo(Print& out);
 
-  // Sampling-based "active tasks" top naar JSON (blokkerend gedurende windowMs).
-  void writeJsonActive(Print& out, uint32_t windowMs = 500, uint32_t stepMs = 1, uint8_t topN = 12);
+  // Extra sectie in writeJsonInfo(): ,"key":<uitvoer van writer> (geldige JSON).
+  // Voor modules buiten TaskMonitor (bv. webserver-cache). Max 4; zelfde key vervangt.
+  void addInfoSection(const char* key, std::function<void(Print&)> writer);
+
+  // Exacte CPU per task (run-time stats, laatste venster) als JSON.
+  void writeJsonTasks(Print& out);
+
+  // Sampling-based "active tasks" top naar JSON. Leest de laatste snapshot van
+  // de achtergrond-sampler (niet blokkerend); bevat age_ms van die snapshot.
+  void writeJsonActive(Print& out, uint8_t topN = 12);
+
+  // History (tiers 1s/1m/1h) van heap_free, heap_min, heap_largest, cpu0, cpu1
+  // (0.1%) en rssi, delta-gecodeerd als JSON of binair. false = onbekende metric/tier.
+  bool writeHistory(Print& out, const char* metric, const char* tier, bool binary = false);
+
+  // Heap-stand, fragmentatie(-historie), mislukte allocaties en (met
+  // -DTASKMONITOR_HEAP_PROFILE) tellers per task en per route als JSON.
+  void writeJsonHeap(Print& out);
+
+  // Laagste stack-headroom (bytes) per task sinds boot als JSON.
+  void writeJsonStacks(Print& out);
+
+  // Callback als een task onder thresholdBytes headroom komt (één keer per
+  // task). Wordt vanuit loop() aangeroepen, dus loggen naar flash mag.
+  void onStackLow(std::function<void(const char* task, uint32_t headroom)> cb,
+                  uint32_t thresholdBytes = 512);
+
+  // Latency-histogrammen (p50/p90/p99/max, µs) van de LoopScope-meetpunten.
+  void writeJsonLoop(Print& out);
+  void resetLoopStats();
+
+  // RAII meetpunt: registreert de duur van de scope in het histogram met
+  // deze naam (string literal, max 8 namen). Bedoeld voor loop() en de
+  // service-calls daarin.
+  class LoopScope {
+  public:
+    explicit LoopScope(const char* name);
+    ~LoopScope();
+  private:
+    int8_t   _slot;
+    uint32_t _startUs;
+  };
+
+  // Statistische PC-profiler op de sampler-ISR's (beide cores). Start een
+  // meting van ms milliseconden; retourneert een id, of 0 als er al één
+  // loopt of wordt gelezen, of geen geheugen. De lezer roept profileRelease(id)
+  // aan als hij klaar of afgebroken is.
+  uint32_t profileStart(uint32_t ms);
+  bool profileReady();
+  void profileRelease(uint32_t id);
+
+  // Resultaat als tekst ("task<TAB>0xpc<TAB>core<TAB>count" per regel), in
+  // stukken voor een chunked response; 0 = klaar. Symboliseren op de host
+  // met scripts/profile_symbolize.py.
+  size_t profileRead(uint8_t* buf, size_t maxLen);
+
+  // Start/stop ESP-IDF heap leak-tracing; false als dat niet in de build zit.
+  bool heapTrace(bool on);
+
+  // RAII scope die heap-gebruik aan een route toeschrijft zolang de handler
+  // loopt. Zonder -DTASKMONITOR_HEAP_PROFILE doet hij niets. Gebruik een
+  // string literal als naam.
+  class HeapRouteScope {
+  public:
+    explicit HeapRouteScope(const char* route);
+    ~HeapRouteScope();
+  private:
+    int8_t   _idx;
+    uint32_t _freeBefore;
+  };
 }
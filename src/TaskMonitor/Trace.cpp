@@ -0,0 +1,181 @@
+#include "Trace.h"
+#include "IdleLoad.h"
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <atomic>
+#include <algorithm>
+
+// Per core één ring; een slot wordt gereserveerd met een atomische
+// fetch_add, dus ook een task die midden in een event gepreempt wordt (of
+// van core wisselt) deelt geen lock met anderen. Elk event draagt zijn
+// volgnummer; de lezer neemt alleen events waarvan het volgnummer vóór en
+// na het kopiëren klopt (niet half overschreven).
+
+#ifndef TASKMONITOR_TRACE_EVENTS
+  #define TASKMONITOR_TRACE_EVENTS 256
+#endif
+
+namespace TaskMonitor {
+
+#ifdef TASKMONITOR_TRACE
+namespace detail {
+
+static const uint32_t RING = TASKMONITOR_TRACE_EVENTS;
+static_assert((RING & (RING - 1)) == 0, "TASKMONITOR_TRACE_EVENTS must be a power of two");
+
+struct TraceRec {
+  std::atomic<uint32_t> seq;    // (index << 1) | begin; 0 = leeg
+  uint32_t     ts;              // µs (esp_timer, 32 bit)
+  const char*  name;
+  TaskHandle_t task;
+};
+
+struct TraceRing {
+  std::atomic<uint32_t> head;
+  TraceRec rec[RING];
+};
+
+static TraceRing         s_ring[portNUM_PROCESSORS];
+static std::atomic<bool> s_on{true};
+
+void traceEvent(const char* name, bool begin) {
+  if (!s_on.load(std::memory_order_relaxed) || xPortInIsrContext()) return;
+  TraceRing& r = s_ring[xPortGetCoreID()];
+  const uint32_t idx = r.head.fetch_add(1, std::memory_order_relaxed) + 1;   // 1-based: 0 = leeg
+  TraceRec& e = r.rec[idx & (RING - 1)];
+  e.seq.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  e.ts   = (uint32_t)esp_timer_get_time();
+  e.name = name;
+  e.task = xTaskGetCurrentTaskHandle();
+  e.seq.store((idx << 1) | (begin ? 1u : 0u), std::memory_order_release);
+}
+
+} // namespace detail
+#endif
+
+// ---------------- public ----------------
+#ifdef TASKMONITOR_TRACE
+bool traceAvailable() { return true; }
+void traceEnable(bool on) { detail::s_on.store(on); }
+bool traceEnabled() { return detail::s_on.load(); }
+void traceClear() {
+  for (uint8_t c=0; c<portNUM_PROCESSORS; ++c) {
+    for (uint32_t i=0; i<detail::RING; ++i) detail::s_ring[c].rec[i].seq.store(0);
+  }
+}
+#else
+bool traceAvailable() { return false; }
+void traceEnable(bool) {}
+bool traceEnabled() { return false; }
+void traceClear() {}
+#endif
+
+// ---------------- export ----------------
+struct Ev { uint32_t ts; const char* name; TaskHandle_t task; uint8_t core; bool begin; };
+
+struct TraceExport::State {
+  Ev*      ev = nullptr;
+  size_t   count = 0;
+  detail::TaskLoad names[detail::MAX_TASK_LOADS];
+  size_t   nameCount = 0;
+  size_t   pos = 0;         // volgend event (na de metadata)
+  size_t   meta = 0;        // volgende thread_name regel
+  uint8_t  stage = 0;       // 0 = kop, 1 = metadata, 2 = events, 3 = staart, 4 = klaar
+  char     line[160];
+  size_t   lineLen = 0, lineOff = 0;
+  bool     first = true;
+
+  bool nextLine();          // één JSON-stuk in line; false = klaar
+};
+
+TraceExport::TraceExport() : _s(new State()) {
+#ifdef TASKMONITOR_TRACE
+  using namespace detail;
+  _s->ev = (Ev*)malloc(sizeof(Ev) * RING * portNUM_PROCESSORS);
+  if (_s->ev) {
+    for (uint8_t c=0; c<portNUM_PROCESSORS; ++c) {
+      const TraceRing& r = s_ring[c];
+      const uint32_t head = r.head.load(std::memory_order_acquire);
+      for (uint32_t idx = head > RING ? head - RING + 1 : 1; idx && idx <= head; ++idx) {
+        const TraceRec& e = r.rec[idx & (RING - 1)];
+        const uint32_t seq = e.seq.load(std::memory_order_acquire);
+        if ((seq >> 1) != (idx & 0x7FFFFFFFu)) continue;       // leeg of al overschreven
+        Ev v{ e.ts, e.name, e.task, c, (seq & 1u) != 0 };
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (e.seq.load(std::memory_order_relaxed) != seq) continue;
+        _s->ev[_s->count++] = v;
+      }
+    }
+    // tijdsvolgorde over beide cores (insertion sort: rings zijn al bijna gesorteerd)
+    for (size_t i=1; i<_s->count; ++i) {
+      Ev key = _s->ev[i];
+      size_t j = i;
+      while (j > 0 && (int32_t)(_s->ev[j-1].ts - key.ts) > 0) { _s->ev[j] = _s->ev[j-1]; --j; }
+      _s->ev[j] = key;
+    }
+  }
+#endif
+  _s->nameCount = detail::idleLoadTasks(_s->names, detail::MAX_TASK_LOADS, nullptr);
+}
+
+TraceExport::~TraceExport() {
+  free(_s->ev);
+  delete _s;
+}
+
+size_t TraceExport::read(uint8_t* buf, size_t maxLen) {
+  size_t n = 0;
+  while (n < maxLen) {
+    if (_s->lineOff == _s->lineLen) {
+      _s->lineOff = _s->lineLen = 0;
+      if (!_s->nextLine()) break;
+    }
+    const size_t take = std::min(maxLen - n, _s->lineLen - _s->lineOff);
+    memcpy(buf + n, _s->line + _s->lineOff, take);
+    _s->lineOff += take;
+    n += take;
+  }
+  return n;
+}
+
+bool TraceExport::State::nextLine() {
+  const char* sep = first ? "" : ",";
+  int len = 0;
+  switch (stage) {
+    case 0:
+      len = snprintf(line, sizeof(line), "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+      stage = 1;
+      break;
+    case 1:
+      if (meta >= nameCount) { stage = 2; return nextLine(); }
+      len = snprintf(line, sizeof(line),
+                     "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%lu,\"args\":{\"name\":\"%s\"}}",
+                     sep, (unsigned long)(uintptr_t)names[meta].h, names[meta].name);
+      meta++;
+      first = false;
+      break;
+    case 2: {
+      if (pos >= count) { stage = 3; return nextLine(); }
+      const Ev& e = ev[pos++];
+      len = snprintf(line, sizeof(line),
+                     "%s\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%lu,\"pid\":1,\"tid\":%lu,\"args\":{\"core\":%u}}",
+                     sep, e.name ? e.name : "?", e.begin ? 'B' : 'E', (unsigned long)e.ts,
+                     (unsigned long)(uintptr_t)e.task, (unsigned)e.core);
+      first = false;
+      break;
+    }
+    case 3:
+      len = snprintf(line, sizeof(line), "]}\n");
+      stage = 4;
+      break;
+    default:
+      return false;
+  }
+  if (len < 0) return false;
+  lineLen = std::min((size_t)len, sizeof(line) - 1);
+  return true;
+}
+
+} // namespace TaskMonitor
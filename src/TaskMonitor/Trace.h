@@ -0,0 +1,55 @@
+#pragma once
+#include <Arduino.h>
+
+// Scoped trace-events (begin/end met esp_timer tijdstempels) in per-core
+// ringbuffers, te bekijken via /sys/trace in Perfetto / chrome://tracing.
+//
+//   TRACE_SCOPE("fs/list");     // tot het einde van de scope
+//
+// Alleen met -DTASKMONITOR_TRACE; anders is TRACE_SCOPE leeg. Ringgrootte per
+// core: -DTASKMONITOR_TRACE_EVENTS=<macht van 2> (default 256 events, 16 B/st).
+
+namespace TaskMonitor {
+  // true als trace in de build zit.
+  bool traceAvailable();
+
+  // Opname pauzeren/hervatten (default aan) en buffers legen.
+  void traceEnable(bool on);
+  bool traceEnabled();
+  void traceClear();
+
+  // Chrome Trace Event JSON van de buffers. De constructor maakt een kopie
+  // (ook bij lopende opname consistent); read() levert de JSON in stukken,
+  // bruikbaar als filler voor een chunked response. 0 = klaar.
+  class TraceExport {
+  public:
+    TraceExport();
+    ~TraceExport();
+    size_t read(uint8_t* buf, size_t maxLen);
+  private:
+    struct State;
+    State* _s;
+  };
+
+#ifdef TASKMONITOR_TRACE
+  namespace detail {
+    void traceEvent(const char* name, bool begin);
+  }
+
+  class TraceScope {
+  public:
+    explicit TraceScope(const char* name) : _name(name) { detail::traceEvent(_name, true); }
+    ~TraceScope() { detail::traceEvent(_name, false); }
+  private:
+    const char* _name;
+  };
+#endif
+}
+
+#ifdef TASKMONITOR_TRACE
+  #define TM_TRACE_CAT2(a, b) a##b
+  #define TM_TRACE_CAT(a, b)  TM_TRACE_CAT2(a, b)
+  #define TRACE_SCOPE(name)   TaskMonitor::TraceScope TM_TRACE_CAT(_traceScope, __LINE__)(name)
+#else
+  #define TRACE_SCOPE(name)   do {} while (0)
+#endif
@@ -0,0 +1,129 @@
+#include "Admission.h"
+#include <esp_heap_caps.h>
+#include <TaskMonitor/Trace.h>
+#include <Json/JsonWriter.h>
+
+namespace Admission {
+
+namespace {
+  // Alle state wordt alleen vanuit de async_tcp task aangeraakt (middleware
+  // en onDisconnect), dus zonder locks.
+  struct Bucket { uint32_t ip; uint32_t milliTokens; uint32_t lastMs; };
+  const uint8_t BUCKETS = 8;                  // meest recente clients; oudste wordt hergebruikt
+
+  Limits   s_limits;
+  uint8_t  s_inflight = 0;
+  uint8_t  s_byClass[RC_COUNT] = {0, 0, 0};
+  Bucket   s_buckets[BUCKETS];
+  uint32_t s_admitted = 0;
+  uint32_t s_rejBusy = 0, s_rejRate = 0, s_rejHeap = 0;
+
+  const char* const CLASS_NAMES[RC_COUNT] = { "static", "api", "heavy" };
+
+  bool startsWith(const String& url, const char* prefix) {
+    return strncmp(url.c_str(), prefix, strlen(prefix)) == 0;
+  }
+
+  // false = altijd toelaten en niet meetellen.
+  bool classify(const String& url, RouteClass& out) {
+    if (url == "/health" || url == "/fs/upload" || url == "/fs/file" ||
+        url == "/fs/unpack") return false;
+    if (url == "/fs/download" || url == "/fs/list" || url == "/fs/archive" || url == "/sys/trace" ||
+        url == "/sys/profile" || url == "/events") { out = RC_HEAVY; return true; }
+    if (url == "/info" || url == "/metrics" || url == "/batch" ||
+        startsWith(url, "/sys/") || startsWith(url, "/fs/")) { out = RC_API; return true; }
+    out = RC_STATIC;
+    return true;
+  }
+
+  // Token bucket; retryS = seconden tot er weer een token is.
+  bool takeToken(uint32_t ip, uint32_t& retryS) {
+    if (!s_limits.ratePerSec) return true;
+    const uint32_t now = millis();
+    const uint32_t cap = (uint32_t)s_limits.rateBurst * 1000UL;
+    Bucket* b = nullptr;
+    for (Bucket& c : s_buckets) if (c.ip == ip) { b = &c; break; }
+    if (!b) {
+      b = &s_buckets[0];
+      for (Bucket& c : s_buckets) if (c.lastMs < b->lastMs) b = &c;
+      *b = { ip, cap, now };
+    }
+    // milli-tokens: per verstreken ms komen er ratePerSec bij
+    const uint64_t refill = (uint64_t)(now - b->lastMs) * s_limits.ratePerSec;
+    b->milliTokens = (uint32_t)std::min<uint64_t>(cap, b->milliTokens + refill);
+    b->lastMs = now;
+    if (b->milliTokens >= 1000) { b->milliTokens -= 1000; return true; }
+    retryS = (1000 - b->milliTokens + (uint32_t)s_limits.ratePerSec * 1000 - 1) / ((uint32_t)s_limits.ratePerSec * 1000);
+    if (!retryS) retryS = 1;
+    return false;
+  }
+
+  void reject(AsyncWebServerRequest* req, const char* reason, uint32_t retryS) {
+    AsyncWebServerResponse* res = req->beginResponse(503, "application/json",
+      String("{\"error\":\"") + reason + "\"}");
+    res->addHeader("Retry-After", String(retryS));
+    res->addHeader("Cache-Control", "no-store");
+    req->send(res);
+  }
+}
+
+void configure(const Limits& limits) {
+  s_limits = limits;
+}
+
+void install(AsyncWebServer& srv) {
+  srv.addMiddleware([](AsyncWebServerRequest* req, ArMiddlewareNext next){
+    RouteClass cls;
+    if (!classify(req->url(), cls)) { next(); return; }
+    TRACE_SCOPE("admission");
+
+    const size_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    const size_t floor = cls == RC_HEAVY ? s_limits.minLargestBlockHeavy : s_limits.minLargestBlock;
+    if (largest < floor) { s_rejHeap++; reject(req, "low_memory", 2); return; }
+
+    uint32_t retryS = 1;
+    const uint32_t ip = req->client() ? (uint32_t)req->client()->remoteIP() : 0;
+    // Statische assets niet: één page load is al ~17 module/CSS-requests
+    // (en elke reload valideert ze opnieuw); heap en concurrency dekken die.
+    if (cls != RC_STATIC && !takeToken(ip, retryS)) { s_rejRate++; reject(req, "rate_limited", retryS); return; }
+
+    // SSE: de verbinding wordt door AsyncEventSource overgenomen en blijft
+    // open; die heeft zijn eigen clientlimiet, dus geen slot bezetten.
+    if (req->url() == "/events") { s_admitted++; next(); return; }
+
+    const uint8_t maxCls = s_limits.maxPerClass[cls];
+    if ((s_limits.maxConcurrent && s_inflight >= s_limits.maxConcurrent) ||
+        (maxCls && s_byClass[cls] >= maxCls)) {
+      s_rejBusy++; reject(req, "busy", 1); return;
+    }
+
+    s_inflight++;
+    s_byClass[cls]++;
+    s_admitted++;
+    next();
+    // Pas na de handler: uploads gebruiken onDisconnect tot hun completion
+    // handler klaar is. De request (en zijn response) leeft tot de disconnect.
+    req->onDisconnect([cls]() {
+      if (s_inflight) s_inflight--;
+      if (s_byClass[cls]) s_byClass[cls]--;
+    });
+  });
+}
+
+void writeJson(Print& out) {
+  JsonWriter j(out);
+  j.beginObject();
+  j.field(F("inflight"), s_inflight);
+  j.beginObject(F("by_class"));
+  for (uint8_t c=0; c<RC_COUNT; ++c) j.field(CLASS_NAMES[c], s_byClass[c]);
+  j.endObject();
+  j.field(F("admitted"), s_admitted);
+  j.beginObject(F("rejected"));
+  j.field(F("busy"), s_rejBusy);
+  j.field(F("rate"), s_rejRate);
+  j.field(F("heap"), s_rejHeap);
+  j.endObject();
+  j.endObject();
+}
+
+} // namespace Admission
@@ -0,0 +1,42 @@
+#pragma once
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+
+// Toelatingscontrole voor de webserver (middleware). Per request, vóór de
+// handler:
+//  - heap: 503 als het grootste vrije blok onder de drempel zakt (voor zware
+//    routes een hogere drempel), zodat WiFi/lwIP hun buffers nog krijgen;
+//  - gelijktijdigheid: maximum totaal en per routeklasse;
+//  - rate limit: token bucket per client-IP, alleen voor API/zware routes.
+// Afwijzen = 503 + Retry-After. /health en uploads (de body is op dit punt
+// al verwerkt) worden altijd toegelaten.
+namespace Admission {
+  enum RouteClass : uint8_t { RC_STATIC, RC_API, RC_HEAVY, RC_COUNT };
+
+  struct Limits {
+    uint8_t  maxConcurrent;             // alle klassen samen (0 = geen limiet)
+    uint8_t  maxPerClass[RC_COUNT];     // static / api / heavy (0 = geen limiet)
+    uint16_t ratePerSec;                // tokens per seconde per IP (0 = uit); static telt niet mee
+    uint16_t rateBurst;                 // bucketgrootte
+    size_t   minLargestBlock;           // heap-drempel voor alle requests
+    size_t   minLargestBlockHeavy;      // drempel voor downloads/lists/archive/trace/profile/events
+
+    Limits()
+    : maxConcurrent(8)
+    , maxPerClass{6, 4, 2}
+    , ratePerSec(10)
+    , rateBurst(20)
+    , minLargestBlock(12 * 1024)
+    , minLargestBlockHeavy(24 * 1024)
+    {}
+  };
+
+  void configure(const Limits& limits);
+
+  // Voegt de middleware toe; na installMetrics aanroepen, zodat ook de
+  // afgewezen requests in de statuscounters terechtkomen.
+  void install(AsyncWebServer& srv);
+
+  // {"inflight":..,"by_class":[..],"admitted":..,"rejected":{"busy":..,"rate":..,"heap":..}}
+  void writeJson(Print& out);
+}
@@ -0,0 +1,99 @@
+#include "AssetCache.h"
+#include <LittleFS.h>
+#include <esp_heap_caps.h>
+#include <vector>
+#include <Json/JsonWriter.h>
+
+namespace AssetCache {
+
+namespace {
+  struct Item {
+    String   file;
+    uint32_t crc;
+    size_t   len;
+    uint32_t lastUse;
+    std::shared_ptr<uint8_t> data;
+  };
+
+  // Onder deze vrije heap geven we geheugen terug i.p.v. te cachen.
+  const size_t HEAP_FLOOR = 40 * 1024;
+
+  std::vector<Item> s_items;
+  size_t   s_budget  = 0;
+  size_t   s_maxFile = 0;
+  size_t   s_bytes   = 0;
+  uint32_t s_clock   = 0;
+  uint32_t s_hits = 0, s_misses = 0, s_evictions = 0;
+
+  void evictLru() {
+    if (s_items.empty()) return;
+    size_t lru = 0;
+    for (size_t i=1; i<s_items.size(); ++i) if (s_items[i].lastUse < s_items[lru].lastUse) lru = i;
+    s_bytes -= s_items[lru].len;
+    s_items.erase(s_items.begin() + lru);
+    s_evictions++;
+  }
+
+  bool heapLow(size_t extra) {
+    return heap_caps_get_free_size(MALLOC_CAP_8BIT) < HEAP_FLOOR + extra ||
+           heap_caps_get_largest_free_block(MALLOC_CAP_8BIT) < extra;
+  }
+}
+
+void configure(size_t budgetBytes, size_t maxFileBytes) {
+  s_budget  = budgetBytes;
+  s_maxFile = maxFileBytes;
+  while (s_bytes > s_budget) evictLru();
+}
+
+std::shared_ptr<uint8_t> fetch(const String& file, uint32_t crc, size_t& len) {
+  if (!s_budget) return nullptr;
+  while (!s_items.empty() && heapLow(0)) evictLru();     // heap-druk: terug naar streamen
+
+  for (Item& it : s_items) {
+    if (it.crc != crc || it.file != file) continue;
+    it.lastUse = ++s_clock;
+    s_hits++;
+    len = it.len;
+    return it.data;
+  }
+  s_misses++;
+
+  File f = LittleFS.open(file, "r");
+  if (!f) return nullptr;
+  const size_t size = f.size();
+  if (!size || size > s_maxFile || size > s_budget) { f.close(); return nullptr; }
+
+  while (!s_items.empty() && (s_bytes + size > s_budget || heapLow(size))) evictLru();
+  if (heapLow(size)) { f.close(); return nullptr; }
+
+  std::shared_ptr<uint8_t> data((uint8_t*)malloc(size), free);
+  if (!data) { f.close(); return nullptr; }
+  const size_t got = f.read(data.get(), size);
+  f.close();
+  if (got != size) return nullptr;
+
+  s_items.push_back(Item{file, crc, size, ++s_clock, data});
+  s_bytes += size;
+  len = size;
+  return data;
+}
+
+void clear() {
+  s_items.clear();
+  s_bytes = 0;
+}
+
+void writeJson(Print& out) {
+  JsonWriter j(out);
+  j.beginObject();
+  j.field(F("budget"),    (uint32_t)s_budget);
+  j.field(F("bytes"),     (uint32_t)s_bytes);
+  j.field(F("entries"),   (uint32_t)s_items.size());
+  j.field(F("hits"),      s_hits);
+  j.field(F("misses"),    s_misses);
+  j.field(F("evictions"), s_evictions);
+  j.endObject();
+}
+
+} // namespace AssetCache
@@ -0,0 +1,22 @@
+#pragma once
+#include <Arduino.h>
+#include <memory>
+
+// LRU-cache in RAM voor kleine, vaak opgevraagde statische bestanden.
+// Sleutel = bestandsnaam (incl. .gz/.br) + CRC uit de FileIndex, dus een
+// gewijzigd bestand geeft vanzelf een miss; oude entries verouderen weg.
+// Buffers zijn shared_ptr: een lopende response houdt zijn buffer vast, ook
+// als de entry intussen is verdrongen.
+namespace AssetCache {
+  // budgetBytes = totaal voor alle entries (0 = uit); maxFileBytes = grootste bestand.
+  void configure(size_t budgetBytes, size_t maxFileBytes);
+
+  // Inhoud van file uit de cache, of (bij een miss) ingelezen en opgeslagen
+  // als budget en heap het toelaten. nullptr = niet cachen, gewoon streamen.
+  std::shared_ptr<uint8_t> fetch(const String& file, uint32_t crc, size_t& len);
+
+  void clear();
+
+  // {"budget","bytes","entries","hits","misses","evictions"}
+  void writeJson(Print& out);
+}
@@ -0,0 +1,92 @@
+#include "AssetPack.h"
+#include <esp_partition.h>
+
+namespace AssetPack {
+
+namespace {
+  const esp_partition_subtype_t SUBTYPE = (esp_partition_subtype_t)0x40;
+  const char*    LABEL = "assets";
+  const uint32_t HEADER_SIZE = 16;
+  const uint32_t ENTRY_SIZE  = 24;
+
+  const uint8_t*          s_base = nullptr;
+  uint32_t                s_size = 0;
+  uint16_t                s_count = 0;
+  uint32_t                s_built = 0;
+  spi_flash_mmap_handle_t s_handle = 0;
+
+  inline uint32_t rd32(const uint8_t* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+  inline uint16_t rd16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+
+  uint32_t fnv1a(const char* s, size_t n) {
+    uint32_t h = 2166136261u;
+    for (size_t i=0; i<n; ++i) { h ^= (uint8_t)s[i]; h *= 16777619u; }
+    return h;
+  }
+
+  bool item(uint16_t i, Item& out) {
+    const uint8_t* e = s_base + HEADER_SIZE + (uint32_t)i * ENTRY_SIZE;
+    const uint32_t nameOff = rd32(e + 4), dataOff = rd32(e + 8), size = rd32(e + 12);
+    if (nameOff >= s_size || dataOff > s_size || size > s_size - dataOff) return false;
+    out.name    = (const char*)(s_base + nameOff);
+    out.data    = s_base + dataOff;
+    out.size    = size;
+    out.crc     = rd32(e + 16);
+    out.variant = e[20];
+    return true;
+  }
+}
+
+bool begin() {
+  if (s_base) return true;
+  const esp_partition_t* part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, SUBTYPE, LABEL);
+  if (!part) return false;
+
+  const void* ptr = nullptr;
+  if (esp_partition_mmap(part, 0, part->size, SPI_FLASH_MMAP_DATA, &ptr, &s_handle) != 0) {
+    Serial.println(F("[Web] Asset partition mmap FAILED"));
+    return false;
+  }
+  const uint8_t* base = (const uint8_t*)ptr;
+  const uint32_t size = rd32(base + 12);
+  if (memcmp(base, "TMAP", 4) != 0 || rd16(base + 4) != 1 || size > part->size ||
+      HEADER_SIZE + (uint32_t)rd16(base + 6) * ENTRY_SIZE > size) {
+    Serial.println(F("[Web] Asset partition empty or invalid (run pack_assets / uploadassets)"));
+    spi_flash_munmap(s_handle);
+    return false;
+  }
+  s_base  = base;
+  s_size  = size;
+  s_count = rd16(base + 6);
+  s_built = rd32(base + 8);
+  Serial.printf("[Web] Asset partition: %u files, %lu bytes mapped\n", s_count, (unsigned long)s_size);
+  return true;
+}
+
+bool mounted() { return s_base != nullptr; }
+uint32_t buildTime() { return s_built; }
+
+bool find(const String& file, Item& out) {
+  if (!s_base) return false;
+  // hash is over het logische pad (zonder .gz/.br)
+  size_t logicalLen = file.length();
+  if (file.endsWith(".gz") || file.endsWith(".br")) logicalLen -= 3;
+  const uint32_t h = fnv1a(file.c_str(), logicalLen);
+
+  uint16_t lo = 0, hi = s_count;
+  while (lo < hi) {                                    // eerste entry met hash >= h
+    const uint16_t mid = (uint16_t)((lo + hi) / 2);
+    if (rd32(s_base + HEADER_SIZE + (uint32_t)mid * ENTRY_SIZE) < h) lo = mid + 1; else hi = mid;
+  }
+  for (uint16_t i=lo; i<s_count && rd32(s_base + HEADER_SIZE + (uint32_t)i * ENTRY_SIZE) == h; ++i) {
+    if (item(i, out) && strcmp(out.name, file.c_str()) == 0) return true;
+  }
+  return false;
+}
+
+void forEach(std::function<void(const Item&)> fn) {
+  Item it;
+  for (uint16_t i=0; i<s_count; ++i) if (item(i, it)) fn(it);
+}
+
+} // namespace AssetPack
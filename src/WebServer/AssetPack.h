@@ -0,0 +1,34 @@
+#pragma once
+#include <Arduino.h>
+#include <functional>
+
+// Read-only asset-image in een eigen flash-partitie ("assets", data/0x40),
+// gemaakt door scripts/pack_assets.py en met esp_partition_mmap in het
+// adresbereik gemapt. Responses wijzen direct in die (flash-cache) data:
+// geen file handles, geen kopie in RAM, geen FS-lock.
+//
+// Image (little endian, 4-byte aligned):
+//   header  "TMAP" ver(u16) count(u16) built(u32, unix) size(u32)
+//   entries count x { hash(u32, FNV-1a van het logische pad) name_off(u32)
+//                     data_off(u32) size(u32) crc(u32, van de bron) variant(u8) pad(3) }
+//           gesorteerd op hash; namen zijn 0-getermineerd (incl. .gz/.br)
+namespace AssetPack {
+  struct Item {
+    const char*    name;   // pad van dit bestand (incl. .gz/.br), in flash
+    const uint8_t* data;
+    uint32_t       size;
+    uint32_t       crc;    // CRC32 van de bron (ETag, gelijk voor alle varianten)
+    uint8_t        variant;  // FileIndex::Variant
+  };
+
+  // Zoek en map de partitie; false als die er niet is of ongeldig is.
+  bool begin();
+  bool mounted();
+  uint32_t buildTime();
+
+  // Bestand (incl. .gz/.br) opzoeken.
+  bool find(const String& file, Item& out);
+
+  // Alle bestanden (voor het manifest).
+  void forEach(std::function<void(const Item&)> fn);
+}
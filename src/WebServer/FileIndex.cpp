@@ -0,0 +1,204 @@
+#include "FileIndex.h"
+#include <LittleFS.h>
+#include <esp_rom_crc.h>
+#include <algorithm>
+#include <vector>
+#include "HttpUtils.h"
+#include "AssetPack.h"
+
+namespace FileIndex {
+
+namespace {
+  std::vector<Entry> s_entries;      // gesorteerd op hash
+
+  uint32_t fnv1a(const char* s) {
+    uint32_t h = 2166136261u;
+    while (*s) { h ^= (uint8_t)*s++; h *= 16777619u; }
+    return h;
+  }
+
+  // Pad zonder .gz/.br; variant = welke het was.
+  String logicalPath(const String& path, uint8_t& variant) {
+    if (path.endsWith(".gz")) { variant = V_GZ; return path.substring(0, path.length() - 3); }
+    if (path.endsWith(".br")) { variant = V_BR; return path.substring(0, path.length() - 3); }
+    variant = V_PLAIN;
+    return path;
+  }
+
+  std::vector<Entry>::iterator lowerBound(uint32_t hash) {
+    return std::lower_bound(s_entries.begin(), s_entries.end(), hash,
+                            [](const Entry& e, uint32_t h){ return e.hash < h; });
+  }
+
+  Entry* findMutable(const String& path) {
+    const uint32_t h = fnv1a(path.c_str());
+    for (auto it = lowerBound(h); it != s_entries.end() && it->hash == h; ++it) {
+      if (it->path == path) return &*it;
+    }
+    return nullptr;
+  }
+
+  // Varianten uit de asset-partitie; false als die het pad niet heeft.
+  bool fillFromPack(Entry& e) {
+    static const char* const SUFFIX[3] = { "", ".gz", ".br" };
+    e.variants = 0;
+    for (uint8_t v=0; v<3; ++v) {
+      AssetPack::Item it;
+      if (!AssetPack::find(e.path + SUFFIX[v], it)) continue;
+      if (!e.variants || v == 0) e.size = it.size;       // bron = plain, anders eerste variant
+      e.variants |= (uint8_t)(1u << v);
+      e.crc = it.crc;
+    }
+    e.packed = e.variants != 0;
+    e.mtime  = AssetPack::buildTime();
+    return e.packed;
+  }
+
+  // Grootte/mtime (en CRC voor assets) van de bronvariant invullen.
+  void describe(Entry& e) {
+    e.packed = false;
+    const String src = (e.variants & V_PLAIN) ? e.path
+                     : (e.variants & V_GZ)    ? e.path + ".gz" : e.path + ".br";
+    File f = LittleFS.open(src, "r");
+    if (!f) { e.variants = 0; return; }
+    e.size  = f.size();
+    e.mtime = f.getLastWrite();
+    e.crc   = 0;
+    if (e.tagged) {
+      uint8_t buf[512];
+      for (;;) {
+        const size_t n = f.read(buf, sizeof(buf));
+        if (!n) break;
+        e.crc = esp_rom_crc32_le(e.crc, buf, n);
+      }
+    }
+    f.close();
+  }
+
+  Entry& insert(const String& logical) {
+    if (Entry* e = findMutable(logical)) return *e;
+    Entry e;
+    e.path     = logical;
+    e.hash     = fnv1a(logical.c_str());
+    e.crc      = 0;
+    e.size     = 0;
+    e.mtime    = 0;
+    e.variants = 0;
+    e.mime     = HttpUtils::mimeIndex(logical);
+    e.tagged   = cacheable(logical);
+    e.packed   = false;
+    return *s_entries.insert(lowerBound(e.hash), e);
+  }
+
+  // UI-mappen; in de root telt alleen index.html. Logs en data blijven buiten
+  // het manifest (geen heap per bestand, geen open/CRC bij de start).
+  const char* const UI_DIRS[] = { "/assets", "/pages", "/www" };
+
+  bool inScopeDir(const String& dir) {
+    for (const char* d : UI_DIRS) if (dir == d) return true;
+    return false;
+  }
+
+  // top = root: alleen UI-mappen in, alleen index.html als bestand.
+  void walk(File dir, bool top) {
+    for (File f = dir.openNextFile(); f; f = dir.openNextFile()) {
+      String path = f.path();
+      if (!path.startsWith("/")) path = "/" + path;
+      if (f.isDirectory()) { if (!top || inScopeDir(path)) walk(f, false); continue; }
+      uint8_t variant = 0;
+      const String logical = logicalPath(path, variant);
+      if (top && !inScope(logical)) continue;
+      insert(logical).variants |= variant;
+    }
+  }
+}
+
+bool inScope(const String& path) {
+  if (path == "/index.html") return true;
+  for (const char* d : UI_DIRS) {
+    const size_t n = strlen(d);
+    if (path.startsWith(d) && path.length() > n && path[n] == '/') return true;
+  }
+  return false;
+}
+
+bool cacheable(const String& path) {
+  return HttpUtils::mimeIndex(path) != HttpUtils::MIME_PLAIN;
+}
+
+void build() {
+  const uint32_t t0 = millis();
+  s_entries.clear();
+  File root = LittleFS.open("/", "r");
+  if (root && root.isDirectory()) walk(root, true);
+  for (Entry& e : s_entries) describe(e);
+  s_entries.erase(std::remove_if(s_entries.begin(), s_entries.end(),
+                                 [](const Entry& e){ return e.variants == 0; }), s_entries.end());
+
+  // Asset-partitie aanvullen (LittleFS gaat voor).
+  size_t packed = 0;
+  AssetPack::forEach([&packed](const AssetPack::Item& it){
+    uint8_t variant = 0;
+    const String logical = logicalPath(it.name, variant);
+    if (findMutable(logical)) return;
+    Entry& e = insert(logical);
+    if (fillFromPack(e)) packed++;
+  });
+  Serial.printf("[Web] Manifest: %u files (%u from asset partition) in %lu ms\n",
+                (unsigned)s_entries.size(), (unsigned)packed, (unsigned long)(millis() - t0));
+}
+
+const Entry* find(const String& path) {
+  return findMutable(path);
+}
+
+bool probe(const String& path, Entry& out) {
+  out.path     = path;
+  out.hash     = fnv1a(path.c_str());
+  out.mime     = HttpUtils::mimeIndex(path);
+  out.tagged   = false;                          // geen CRC: geen ETag, niet cachen
+  out.variants = (uint8_t)((LittleFS.exists(path)         ? V_PLAIN : 0) |
+                           (LittleFS.exists(path + ".gz") ? V_GZ    : 0) |
+                           (LittleFS.exists(path + ".br") ? V_BR    : 0));
+  if (!out.variants) return false;
+  describe(out);
+  return out.variants != 0;
+}
+
+void update(const String& path) {
+  uint8_t variant = 0;
+  const String logical = logicalPath(path, variant);
+  if (!inScope(logical)) return;                 // buiten de UI-boom: niet in het manifest
+  const uint8_t variants = (uint8_t)((LittleFS.exists(logical)         ? V_PLAIN : 0) |
+                                     (LittleFS.exists(logical + ".gz") ? V_GZ    : 0) |
+                                     (LittleFS.exists(logical + ".br") ? V_BR    : 0));
+  if (variants) {
+    Entry& e = insert(logical);
+    e.variants = variants;
+    describe(e);
+    if (e.variants) return;
+  } else if (Entry* e = findMutable(logical)) {
+    if (fillFromPack(*e)) return;                // LittleFS-kopie weg: partitie weer zichtbaar
+  }
+  if (Entry* e = findMutable(logical)) s_entries.erase(s_entries.begin() + (e - s_entries.data()));
+}
+
+String etag(const Entry& e, const char* encoding) {
+  char buf[40];
+  snprintf(buf, sizeof(buf), "\"%08lx-%lx%s%s\"", (unsigned long)e.crc, (unsigned long)e.size,
+           encoding ? "-" : "", encoding ? encoding : "");
+  return String(buf);
+}
+
+String httpDate(time_t t) {
+  if (t <= 0) return String();
+  struct tm tm;
+  gmtime_r(&t, &tm);
+  char buf[32];
+  strftime(buf, sizeof(buf), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+  return String(buf);
+}
+
+size_t count() { return s_entries.size(); }
+
+} // namespace FileIndex
@@ -0,0 +1,57 @@
+#pragma once
+#include <Arduino.h>
+
+// Manifest van de UI-bestanden (/index.html, /assets, /pages, /www),
+// opgebouwd bij WebServerHandler::begin en daarna bijgewerkt door de FS-API
+// (upload/rename/unpack). Per logisch pad: welke varianten er zijn
+// (plain/.gz/.br), grootte, mtime, MIME en voor assets een CRC32 van de
+// inhoud als sterke ETag. Bestanden uit de read-only asset-partitie
+// (AssetPack) komen er ook in; LittleFS gaat voor. Opzoeken = FNV-1a hash +
+// binair zoeken in een gesorteerde tabel; routing raakt LittleFS voor de UI
+// dus niet. Andere bestanden (logs, data) staan er niet in; die vindt
+// probe() op aanvraag.
+namespace FileIndex {
+  enum Variant : uint8_t { V_PLAIN = 1, V_GZ = 2, V_BR = 4 };
+
+  struct Entry {
+    String   path;       // logisch pad (zonder .gz/.br)
+    uint32_t hash;
+    uint32_t crc;        // CRC32 van de bron (plain, anders .gz/.br); alleen als tagged
+    uint32_t size;       // grootte van de bron
+    time_t   mtime;      // 0 = onbekend
+    uint8_t  variants;
+    uint8_t  mime;       // index voor HttpUtils::mimeName()
+    bool     tagged;     // asset-type: ETag/cache mogelijk
+    bool     packed;     // uit de asset-partitie (AssetPack) i.p.v. LittleFS
+  };
+
+  // Volledige scan van de UI-mappen (bij start, of na een directory-rename).
+  void build();
+
+  // true als path onder het manifest valt (UI-boom).
+  bool inScope(const String& path);
+
+  // Entry direct van LittleFS voor een pad buiten het manifest; zonder
+  // CRC/ETag. false = bestaat niet. Binnen inScope() is find() leidend.
+  bool probe(const String& path, Entry& out);
+
+  // Entry voor path; nullptr = bestaat niet.
+  const Entry* find(const String& path);
+
+  // Eén pad opnieuw bepalen na een wijziging (upload, rename van/naar,
+  // verwijderen). Varianten (.gz/.br) worden naar hun logisch pad herleid;
+  // paden buiten de UI-boom worden genegeerd.
+  void update(const String& path);
+
+  // Alleen asset-types (html/css/js/json/svg/afbeeldingen) krijgen een ETag;
+  // logbestanden e.d. veranderen buiten de API om.
+  bool cacheable(const String& path);
+
+  // Sterke ETag voor de gekozen variant, bv. "\"1a2b3c4d-5e1-gzip\"".
+  String etag(const Entry& e, const char* encoding);
+
+  // RFC 7231 datum voor Last-Modified; leeg als mtime onbekend.
+  String httpDate(time_t t);
+
+  size_t count();
+}
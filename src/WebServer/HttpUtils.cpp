@@ -1,5 +1,12 @@
 #include "HttpUtils.h"
 #include <LittleFS.h>
+#include <algorithm>
+#include <memory>
+#include <TaskMonitor/TaskMonitor.h>
+#include <TaskMonitor/Trace.h>
+#include "FileIndex.h"
+#include "AssetCache.h"
+#include "AssetPack.h"
 
 namespace HttpUtils {
 
@@ -22,55 +29,208 @@ void setCacheLong(AsyncWebServerResponse* r){
   if(!r) return;
   r->addHeader("Cache-Control","public, max-age=31536000, immutable");
 }
+void setRevalidate(AsyncWebServerResponse* r){
+  if(!r) return;
+  r->addHeader("Cache-Control","no-cache");
+}
+
+static const char* const MIME_EXT[]  = { "",           ".html",     ".css",     ".js",                     ".json",            ".svg",          ".png",      ".jpg",       ".jpeg",      ".ico" };
+static const char* const MIME_NAME[] = { "text/plain", "text/html", "text/css", "application/javascript", "application/json", "image/svg+xml", "image/png", "image/jpeg", "image/jpeg", "image/x-icon" };
+static const uint8_t MIME_COUNT = sizeof(MIME_EXT) / sizeof(MIME_EXT[0]);
+
+uint8_t mimeIndex(const String& p){
+  for (uint8_t i=1; i<MIME_COUNT; ++i) if (p.endsWith(MIME_EXT[i])) return i;
+  return MIME_PLAIN;
+}
+
+const char* mimeName(uint8_t idx){
+  return MIME_NAME[idx < MIME_COUNT ? idx : MIME_PLAIN];
+}
 
 String guessMime(const String& p){
-  if(p.endsWith(".html")) return "text/html";
-  if(p.endsWith(".css"))  return "text/css";
-  if(p.endsWith(".js"))   return "application/javascript";
-  if(p.endsWith(".json")) return "application/json";
-  if(p.endsWith(".svg"))  return "image/svg+xml";
-  if(p.endsWith(".png"))  return "image/png";
-  if(p.endsWith(".jpg") || p.endsWith(".jpeg")) return "image/jpeg";
-  if(p.endsWith(".ico"))  return "image/x-icon";
-  return "text/plain";
+  return mimeName(mimeIndex(p));
+}
+
+bool assetExists(const String& path) {
+  if (FileIndex::find(path)) return true;
+  if (FileIndex::inScope(path)) return false;    // UI-boom: manifest is leidend
+  FileIndex::Entry e;
+  return FileIndex::probe(path, e);              // buiten het manifest: LittleFS zelf
 }
 
-String jsonEscape(const String& s){
-  String out; out.reserve(s.length()+8);
-  for (size_t i=0;i<s.length();++i){
-    char c=s[i];
-    if(c=='"'||c=='\\') { out += '\\'; out += c; }
-    else if(c=='\n') out += "\\n";
-    else if(c=='\r') out += "\\r";
-    else out += c;
+// Token in Accept-Encoding (lijst, evt. met ;q=). q=0 telt als niet geaccepteerd.
+static bool acceptsEncoding(AsyncWebServerRequest* req, const char* enc) {
+  if (!req->hasHeader("Accept-Encoding")) return false;
+  const String& ae = req->getHeader("Accept-Encoding")->value();
+  const size_t len = strlen(enc);
+  int from = 0;
+  while (from < (int)ae.length()) {
+    int end = ae.indexOf(',', from);
+    if (end < 0) end = ae.length();
+    String tok = ae.substring(from, end);
+    tok.trim();
+    if (tok.startsWith(enc) && (tok.length() == len || tok[len] == ';')) {
+      const int q = tok.indexOf("q=", len);
+      return q < 0 || tok.substring(q + 2).toFloat() > 0.f;   // "q=0", "q=0.0", "q=0.000" = geweigerd
+    }
+    from = end + 1;
   }
-  return out;
+  return false;
 }
 
-void sendJson(AsyncWebServerRequest* req, const String& json) {
-  auto* res = req->beginResponse(200, "application/json", json);
-  res->addHeader("Cache-Control", "no-store");
-  req->send(res);
+// Response die file in stukken vanaf LittleFS leest; nullptr als hij niet opent.
+// Met een Content-Length roept de server de filler niet meer aan na de laatste
+// byte (en niet bij een afgebroken verbinding): het bestand zit daarom in een
+// shared_ptr die de lambda vasthoudt en sluit als de response verdwijnt.
+struct StaticFile {
+  File f;
+  ~StaticFile() { if (f) f.close(); }
+};
+
+static AsyncWebServerResponse* streamFile(AsyncWebServerRequest* req, const String& mime, const String& file) {
+  auto sf = std::make_shared<StaticFile>();
+  sf->f = LittleFS.open(file, "r");
+  if (!sf->f) return nullptr;
+  return req->beginResponse(
+    mime, sf->f.size(),
+    [sf](uint8_t* buffer, size_t maxLen, size_t /*index*/) -> size_t {
+      TRACE_SCOPE("static.chunk");
+      return sf->f.read(buffer, maxLen);
+    }
+  );
+}
+
+static bool parseSize(const String& s, size_t& out) {
+  if (!s.length() || s.length() > 10) return false;
+  uint64_t v = 0;
+  for (size_t i=0; i<s.length(); ++i) {
+    if (s[i] < '0' || s[i] > '9') return false;
+    v = v * 10 + (uint64_t)(s[i] - '0');
+  }
+  if (v > SIZE_MAX) return false;
+  out = (size_t)v;
+  return true;
+}
+
+RangeResult parseRange(const String& header, size_t size, size_t& start, size_t& end) {
+  String h = header; h.trim();
+  if (!h.startsWith("bytes=") || h.indexOf(',') >= 0) return RANGE_NONE;
+  const int dash = h.indexOf('-', 6);
+  if (dash < 0) return RANGE_NONE;
+  const String a = h.substring(6, dash), b = h.substring(dash + 1);
+
+  size_t first = 0, last = 0;
+  if (!a.length()) {                                   // suffix: laatste n bytes
+    if (!parseSize(b, last)) return RANGE_NONE;
+    if (last == 0 || size == 0) return RANGE_UNSATISFIABLE;
+    start = size - std::min(last, size);
+    end   = size - 1;
+    return RANGE_OK;
+  }
+  if (!parseSize(a, first)) return RANGE_NONE;
+  if (b.length()) {
+    if (!parseSize(b, last) || last < first) return RANGE_NONE;
+  } else last = SIZE_MAX;
+  if (first >= size) return RANGE_UNSATISFIABLE;
+  start = first;
+  end   = std::min(last, size - 1);
+  return RANGE_OK;
+}
+
+bool guardAuth(AsyncWebServerRequest* req, bool requireAuth){
+  if (!requireAuth) return true;
+#if defined(WEBSERVER_AUTH_USER) && defined(WEBSERVER_AUTH_PASS)
+  if (req->authenticate(WEBSERVER_AUTH_USER, WEBSERVER_AUTH_PASS)) return true;
+  req->requestAuthentication();
+  return false;
+#else
+  (void)req;
+  return true;
+#endif
+}
+
+// If-None-Match bevat deze ETag (of *)?
+static bool etagMatches(AsyncWebServerRequest* req, const String& tag) {
+  if (!req->hasHeader("If-None-Match")) return false;
+  const String& inm = req->getHeader("If-None-Match")->value();
+  return inm.indexOf(tag) >= 0 || inm == "*";
 }
 
 void sendFilePlain(AsyncWebServerRequest* req, String path) {
+  TaskMonitor::HeapRouteScope heapScope("static");
+  TRACE_SCOPE("static");
   if (!path.startsWith("/")) path = "/" + path;
-  if (!LittleFS.exists(path)) { req->send(404, "text/plain", "Not found"); return; }
-
-  File* f = new File(LittleFS.open(path, "r"));
-  if (!(*f)) { delete f; req->send(404, "text/plain", "Not found"); return; }
-
-  const String mime = guessMime(path);
-  AsyncWebServerResponse* res = req->beginChunkedResponse(
-    mime,
-    [f](uint8_t* buffer, size_t maxLen, size_t /*index*/) -> size_t {
-      if (!(*f)) return 0;
-      size_t n = f->read(buffer, maxLen);
-      if (n == 0) { f->close(); delete f; }
-      return n;
+
+  // Varianten, MIME en ETag uit het manifest: geen LittleFS-reads tot de body.
+  // Mis binnen de UI-boom = 404 (de FS-API houdt het manifest bij); alleen
+  // paden daarbuiten zoeken we op LittleFS.
+  const FileIndex::Entry* idx = FileIndex::find(path);
+  FileIndex::Entry probed;
+  if (!idx) {
+    if (FileIndex::inScope(path) || !FileIndex::probe(path, probed)) { req->send(404, "text/plain", "Not found"); return; }
+    idx = &probed;
+  }
+  const uint8_t variants = idx->variants;
+
+  // Voorgecomprimeerde variant (scripts/compress_assets.py) als de client die aankan.
+  // Bestaat alleen een variant, dan sturen we die toch (alle browsers kennen gzip).
+  const bool hasPlain = variants & FileIndex::V_PLAIN;
+  const char* encoding = nullptr;
+  String file = path;
+  const bool brOnly = !hasPlain && !(variants & FileIndex::V_GZ);
+  if ((variants & FileIndex::V_BR) && (brOnly || acceptsEncoding(req, "br"))) {
+    encoding = "br"; file = path + ".br";
+  } else if ((variants & FileIndex::V_GZ) && (!hasPlain || acceptsEncoding(req, "gzip"))) {
+    encoding = "gzip"; file = path + ".gz";
+  }
+
+  const String mime = mimeName(idx->mime);
+  String tag, lastMod;
+  if (idx->tagged) {
+    tag     = FileIndex::etag(*idx, encoding);
+    lastMod = FileIndex::httpDate(idx->mtime);
+    const bool notModified = req->hasHeader("If-None-Match")
+      ? etagMatches(req, tag)
+      : (lastMod.length() && req->hasHeader("If-Modified-Since") &&
+         req->getHeader("If-Modified-Since")->value() == lastMod);
+    if (notModified) {
+      AsyncWebServerResponse* res = req->beginResponse(304);
+      res->addHeader("ETag", tag);
+      res->addHeader("Vary", "Accept-Encoding");
+      setRevalidate(res);
+      req->send(res);
+      return;
     }
-  );
-  if (mime == "text/html") setNoCache(res); else setCacheLong(res);
+  }
+
+  // Asset-partitie: direct uit gemapt flash. Anders kleine, vaak gevraagde
+  // assets uit RAM en de rest streamen vanaf LittleFS.
+  AsyncWebServerResponse* res = nullptr;
+  size_t len = 0;
+  AssetPack::Item packed;
+  std::shared_ptr<uint8_t> cached;
+  if (idx->packed) {
+    if (!AssetPack::find(file, packed)) { req->send(404, "text/plain", "Not found"); return; }
+    res = req->beginResponse(200, mime.c_str(), packed.data, packed.size);
+  } else if (idx->tagged && (cached = AssetCache::fetch(file, idx->crc, len))) {
+    res = req->beginResponse(mime, len,
+      [cached, len](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+        const size_t n = std::min(maxLen, len - index);
+        memcpy(buffer, cached.get() + index, n);
+        return n;
+      });
+  } else {
+    res = streamFile(req, mime, file);
+    if (!res) { req->send(404, "text/plain", "Not found"); return; }
+  }
+  if (encoding) res->addHeader("Content-Encoding", encoding);
+  res->addHeader("Vary", "Accept-Encoding");
+  if (idx->tagged) {
+    // Namen zijn niet content-hashed: altijd revalideren, een 304 is goedkoop.
+    res->addHeader("ETag", tag);
+    if (lastMod.length()) res->addHeader("Last-Modified", lastMod);
+    setRevalidate(res);
+  } else if (mime == "text/html") setNoCache(res); else setCacheLong(res);
   req->send(res);
 }
 
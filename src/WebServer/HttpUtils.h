@@ -6,8 +6,19 @@ namespace HttpUtils {
   String sanitizePath(const String& in);
   void   setNoCache(AsyncWebServerResponse* r);
   void   setCacheLong(AsyncWebServerResponse* r);
+  void   setRevalidate(AsyncWebServerResponse* r);   // cachen, maar altijd via ETag valideren
   String guessMime(const String& p);
-  String jsonEscape(const String& s);
-  void   sendJson(AsyncWebServerRequest* req, const String& json);
-  void   sendFilePlain(AsyncWebServerRequest* req, String path); // chunked
+
+  // MIME-tabel: index op extensie (MIME_PLAIN = onbekend) en naam bij index.
+  static const uint8_t MIME_PLAIN = 0;
+  uint8_t     mimeIndex(const String& p);
+  const char* mimeName(uint8_t idx);
+  bool   guardAuth(AsyncWebServerRequest* req, bool requireAuth); // false = 401 al verstuurd
+  bool   assetExists(const String& path);                     // ook als alleen .gz/.br bestaat
+
+  // Eén byte-range uit een Range-header ("bytes=a-b", "bytes=a-", "bytes=-n").
+  // RANGE_NONE: geen, onbruikbare of multi-range header -> hele bestand sturen.
+  enum RangeResult : uint8_t { RANGE_NONE, RANGE_OK, RANGE_UNSATISFIABLE };
+  RangeResult parseRange(const String& header, size_t size, size_t& start, size_t& end);
+  void   sendFilePlain(AsyncWebServerRequest* req, String path); // kiest .br/.gz via Accept-Encoding
 }
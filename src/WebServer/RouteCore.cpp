@@ -10,10 +10,10 @@ void installCore(AsyncWebServer& srv){
   // Favicon -> 204
   srv.on("/favicon.ico", HTTP_GET, [](AsyncWebServerRequest* r){ r->send(204); });
 
-  // Root -> /index.html (fallback /www/index.html)
+  // Root -> /index.html (fallback /www/index.html); .gz/.br varianten tellen mee
   srv.on("/", HTTP_GET, [](AsyncWebServerRequest* req){
-    if (LittleFS.exists("/index.html"))     { sendFilePlain(req, "/index.html"); return; }
-    if (LittleFS.exists("/www/index.html")) { sendFilePlain(req, "/www/index.html"); return; }
+    if (assetExists("/index.html"))     { sendFilePlain(req, "/index.html"); return; }
+    if (assetExists("/www/index.html")) { sendFilePlain(req, "/www/index.html"); return; }
     req->send(500, "text/plain", "index.html not found");
   });
 
@@ -23,11 +23,14 @@ void installCore(AsyncWebServer& srv){
     if (!url.startsWith("/")) url = "/" + url;
     if (url.endsWith("/"))    url += "index.html";
 
-    if (url.startsWith("/assets/")) { sendFilePlain(req, url); return; }
-    if (LittleFS.exists(url))       { sendFilePlain(req, url); return; }
+    // Alleen URLs met een extensie kunnen een bestand zijn; SPA deep links
+    // (/settings) gaan zo zonder LittleFS-probe naar de fallback.
+    const bool looksLikeFile = url.lastIndexOf('.') > url.lastIndexOf('/');
+    if (url.startsWith("/assets/"))          { sendFilePlain(req, url); return; }
+    if (looksLikeFile && assetExists(url))   { sendFilePlain(req, url); return; }
 
-    if (LittleFS.exists("/index.html"))     { sendFilePlain(req, "/index.html"); return; }
-    if (LittleFS.exists("/www/index.html")) { sendFilePlain(req, "/www/index.html"); return; }
+    if (assetExists("/index.html"))     { sendFilePlain(req, "/index.html"); return; }
+    if (assetExists("/www/index.html")) { sendFilePlain(req, "/www/index.html"); return; }
 
     req->send(404, "text/plain", "Not found");
   });
@@ -0,0 +1,99 @@
+#include "RoutesBatch.h"
+#include <TaskMonitor/TaskMonitor.h>
+#include <TaskMonitor/Trace.h>
+#include <Json/JsonWriter.h>
+#include "HttpUtils.h"
+#include "RoutesInfo.h"
+#include "RoutesFS.h"
+#include "RoutesMetrics.h"
+
+// /batch: voor clients zonder /events. Eén request, één gestreamde response
+// met dezelfde JSON als de losse endpoints, per naam in één object:
+//   GET /batch?r=info,health,sys,active
+//   {"info":{...},"health":{...},"sys":{...},"active":{...}}
+// Onbekende namen geven 400 vóór er iets gestreamd is.
+
+namespace Routes {
+
+namespace {
+  struct Resource {
+    const char* name;
+    void (*write)(Print&);
+    bool fs;                       // valt onder de FS-API (aan/uit + auth)
+  };
+
+  void writeActive(Print& out) { TaskMonitor::writeJsonActive(out, 12); }
+
+  const Resource RESOURCES[] = {
+    { "info",   writeJsonNetInfo,             false },   // /info
+    { "health", writeJsonHealth,              false },   // /health
+    { "sys",    TaskMonitor::writeJsonInfo,   false },   // /sys/info
+    { "active", writeActive,                  false },   // /sys/active
+    { "tasks",  TaskMonitor::writeJsonTasks,  false },   // /sys/tasks
+    { "heap",   TaskMonitor::writeJsonHeap,   false },   // /sys/heap
+    { "stacks", TaskMonitor::writeJsonStacks, false },   // /sys/stacks
+    { "loop",   TaskMonitor::writeJsonLoop,   false },   // /sys/loop
+    { "http",   writeJsonHttpStats,           false },   // /sys/http
+    { "fs",     writeJsonFsInfo,              true  },   // /fs/info
+  };
+  const uint8_t RESOURCE_COUNT = sizeof(RESOURCES) / sizeof(RESOURCES[0]);
+
+  const char*  DEFAULT_SET = "info,health,sys,active";   // wat het dashboard pollt
+  const size_t BATCH_BUF   = 2048;
+
+  int8_t findResource(const String& name) {
+    for (uint8_t i=0; i<RESOURCE_COUNT; ++i) if (name == RESOURCES[i].name) return (int8_t)i;
+    return -1;
+  }
+}
+
+void installBatch(AsyncWebServer& srv, bool fsApi, bool fsAuth) {
+  srv.on("/batch", HTTP_GET, [fsApi, fsAuth](AsyncWebServerRequest* req){
+    TaskMonitor::HeapRouteScope heapScope("batch");
+    TRACE_SCOPE("batch");
+    const String list = req->hasParam("r") ? req->getParam("r")->value() : String(DEFAULT_SET);
+
+    // Eerst de hele lijst parsen: volgorde van het verzoek, dubbelen één keer.
+    uint8_t order[RESOURCE_COUNT];
+    uint8_t n = 0;
+    uint16_t seen = 0;
+    bool needAuth = false;
+    int from = 0;
+    while (from <= (int)list.length()) {
+      int comma = list.indexOf(',', from);
+      if (comma < 0) comma = list.length();
+      String name = list.substring(from, comma);
+      name.trim();
+      from = comma + 1;
+      if (!name.length()) continue;
+
+      const int8_t i = findResource(name);
+      if (i < 0 || (RESOURCES[i].fs && !fsApi)) {
+        auto* err = req->beginResponseStream("application/json");
+        err->setCode(400);
+        JsonWriter(*err).beginObject().field(F("error"), "unknown_resource").field(F("name"), name).endObject();
+        req->send(err);
+        return;
+      }
+      if (seen & (1u << i)) continue;
+      seen |= (1u << i);
+      order[n++] = (uint8_t)i;
+      needAuth |= RESOURCES[i].fs;
+    }
+    if (needAuth && !HttpUtils::guardAuth(req, fsAuth)) return;
+
+    auto* res = req->beginResponseStream("application/json", BATCH_BUF);
+    JsonWriter j(*res);
+    j.beginObject();
+    for (uint8_t k=0; k<n; ++k) {
+      const Resource& r = RESOURCES[order[k]];
+      j.key(r.name);
+      r.write(j.raw());
+    }
+    j.endObject();
+    res->addHeader("Cache-Control", "no-store");
+    req->send(res);
+  });
+}
+
+} // namespace Routes
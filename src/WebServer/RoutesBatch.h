@@ -0,0 +1,7 @@
+#pragma once
+#include <ESPAsyncWebServer.h>
+
+namespace Routes {
+  // /batch?r=info,health,sys,active,...  (meerdere resources in één response)
+  void installBatch(AsyncWebServer& srv, bool fsApi, bool fsAuth);
+}
@@ -0,0 +1,122 @@
+#include "RoutesEvents.h"
+#include <esp_heap_caps.h>
+#include <TaskMonitor/TaskMonitor.h>
+#include <TaskMonitor/Trace.h>
+#include <Wifihandler/Wifihandler.h>
+#include <DHT11/DHT11.h>
+#include <Soil/Soil.h>
+#include <Json/JsonWriter.h>
+
+// /events: één gecombineerd telemetrie-frame per interval i.p.v. vier
+// polls (/info, /health, /sys/info, /sys/active) per open tab. Het frame
+// wordt één keer opgebouwd in een vaste buffer en naar alle abonnees
+// gestuurd; de velden volgen de namen van de losse endpoints:
+//
+//   event: telemetry
+//   data: {"info":{...},"sys":{"uptime_s":..,"heap_free":..,"heap_min":..,"cpu_load":[..]},
+//          "active":{...zoals /sys/active...},"sensors":{"temp_c":..,"hum_pct":..,"soil_pct":..}}
+
+namespace Routes {
+
+namespace {
+  const uint8_t TOP_TASKS    = 8;
+  const size_t  MAX_WAITING  = 4;     // trage client: frame overslaan i.p.v. opstapelen
+
+  // Vaste framebuffer; alleen de loop-task schrijft erin.
+  class FrameBuf : public Print {
+  public:
+    size_t write(uint8_t c) override {
+      if (_n + 1 >= sizeof(_buf)) { _overflow = true; return 0; }
+      _buf[_n++] = (char)c;
+      return 1;
+    }
+    size_t write(const uint8_t* p, size_t len) override {
+      for (size_t i=0; i<len; ++i) if (!write(p[i])) return i;
+      return len;
+    }
+    void reset() { _n = 0; _overflow = false; }
+    const char* c_str() { _buf[_n] = 0; return _buf; }
+    size_t length() const { return _n; }
+    bool overflow() const { return _overflow; }
+  private:
+    char   _buf[1536];
+    size_t _n = 0;
+    bool   _overflow = false;
+  };
+
+  AsyncEventSource* s_events = nullptr;   // eigendom van de AsyncWebServer
+  FrameBuf          s_frame;
+  uint32_t          s_lastMs = 0;
+  uint32_t          s_id = 0;
+  volatile bool     s_kick = false;       // nieuwe abonnee: volgende loop direct sturen
+
+  void writeNet(JsonWriter& j) {
+    const wifi_mode_t mode = WiFi.getMode();
+    const bool apOn  = mode & WIFI_MODE_AP;
+    const bool staUp = (mode & WIFI_MODE_STA) && WiFiService.isConnected();
+
+    j.beginObject(F("info"));
+    j.field(F("mode"), staUp ? (apOn ? "AP+STA" : "STA") : (apOn ? "AP" : "OFF"));
+    if (staUp)     j.field(F("ip"), WiFi.localIP());
+    else if (apOn) j.field(F("ip"), WiFi.softAPIP());
+    else           j.field(F("ip"), "0.0.0.0");
+    if (staUp)     j.field(F("ssid"), WiFi.SSID());
+    else if (apOn) j.field(F("ssid"), WiFi.softAPSSID());
+    else           j.field(F("ssid"), "");
+    if (staUp) j.field(F("rssi"), (int32_t)WiFiService.rssi()); else j.fieldNull(F("rssi"));
+    j.field(F("ap_clients"), apOn ? WiFi.softAPgetStationNum() : 0);
+    j.endObject();
+  }
+
+  void writeFrame(Print& out) {
+    TRACE_SCOPE("events.frame");
+    float l0 = 0.f, l1 = 0.f;
+    TaskMonitor::getCpuLoadCached(l0, l1);
+
+    JsonWriter j(out);
+    j.beginObject();
+    writeNet(j);
+    j.beginObject(F("sys"));
+    j.field(F("uptime_s"),  (uint32_t)(millis() / 1000UL));
+    j.field(F("heap_free"), (uint32_t)heap_caps_get_free_size(MALLOC_CAP_8BIT));
+    j.field(F("heap_min"),  (uint32_t)heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT));
+    j.beginArray(F("cpu_load")).value(l0, 1).value(l1, 1).endArray();
+    j.endObject();
+    j.key(F("active")); TaskMonitor::writeJsonActive(j.raw(), TOP_TASKS);
+    j.beginObject(F("sensors"));
+    j.field(F("temp_c"),  DHTService.temperature(), 1);
+    j.field(F("hum_pct"), DHTService.humidity(), 1);
+    if (SoilService.percent() >= 0) j.field(F("soil_pct"), SoilService.percent()); else j.fieldNull(F("soil_pct"));
+    j.endObject();
+    j.endObject();
+  }
+}
+
+void installEvents(AsyncWebServer& srv) {
+  s_events = new AsyncEventSource("/events");
+  s_events->onConnect([](AsyncEventSourceClient* client) {
+    Serial.printf("[Web] events: client %s connected\n", client->remoteIP().toString().c_str());
+    s_kick = true;
+  });
+  srv.addHandler(s_events);
+}
+
+void eventsLoop(uint32_t intervalMs) {
+  if (!s_events) return;
+  const uint32_t now = millis();
+  if (!s_kick && now - s_lastMs < intervalMs) return;
+  s_lastMs = now;
+  s_kick = false;
+  if (s_events->count() == 0) return;                          // geen abonnees: niets opbouwen
+  if (s_events->avgPacketsWaiting() > MAX_WAITING) return;     // clients lopen achter
+
+  s_frame.reset();
+  writeFrame(s_frame);
+  if (s_frame.overflow()) {
+    Serial.printf("[Web] events: frame > %u bytes, skipped\n", (unsigned)s_frame.length());
+    return;
+  }
+  s_events->send(s_frame.c_str(), "telemetry", ++s_id);
+}
+
+} // namespace Routes
@@ -0,0 +1,10 @@
+#pragma once
+#include <ESPAsyncWebServer.h>
+
+namespace Routes {
+  void installEvents(AsyncWebServer& srv);   // /events (SSE telemetrie voor het dashboard)
+
+  // Vanuit WebServerHandler::loop(): bouwt elke intervalMs één frame en
+  // stuurt dat naar alle abonnees. Niets te doen zonder abonnees.
+  void eventsLoop(uint32_t intervalMs);
+}
@@ -1,67 +1,782 @@
 #include "RoutesFS.h"
 #include <LittleFS.h>
 #include "HttpUtils.h"
+#include <TaskMonitor/TaskMonitor.h>
+#include <TaskMonitor/Trace.h>
+#include "FileIndex.h"
+#include <Json/JsonWriter.h>
+#include <Faulthandler/ErrorLogger.h>
+#include <memory>
+#include <vector>
+#include <esp_rom_crc.h>
+#include <mbedtls/sha256.h>
 
 using namespace HttpUtils;
 
-static inline bool guardAuth(AsyncWebServerRequest* req, bool requireAuth){
-  if (!requireAuth) return true;
-#if defined(WEBSERVER_AUTH_USER) && defined(WEBSERVER_AUTH_PASS)
-  if (req->authenticate(WEBSERVER_AUTH_USER, WEBSERVER_AUTH_PASS)) return true;
-  req->requestAuthentication();
-  return false;
-#else
-  (void)req;
+namespace {
+
+const size_t LFS_BLOCK = 4096;                  // LittleFS block size (= flash sector)
+
+// tmp -> target; LittleFS vervangt een bestaand doel bij rename, anders eerst verwijderen.
+bool replaceFile(const String& tmp, const String& target) {
+  if (LittleFS.rename(tmp, target)) return true;
+  LittleFS.remove(target);
+  return LittleFS.rename(tmp, target);
+}
+
+// Alle ontbrekende mappen boven path aanmaken ("/a/b/c.txt" -> /a, /a/b).
+bool mkdirs(const String& path) {
+  for (int slash = path.indexOf('/', 1); slash > 0; slash = path.indexOf('/', slash + 1)) {
+    const String dir = path.substring(0, slash);
+    if (!LittleFS.exists(dir) && !LittleFS.mkdir(dir)) return false;
+  }
   return true;
-#endif
 }
 
+// Lopende download: read-ahead buffer van één LittleFS-blok. De eerste read
+// loopt tot de volgende blokgrens, daarna alleen hele, uitgelijnde blokken;
+// de TCP-laag krijgt zo kleine stukken uit RAM i.p.v. een flash-read per chunk.
+// De destructor logt de doorvoer naar ErrorLogger (ook bij een afgebroken transfer).
+struct Download {
+  File     f;
+  String   path;
+  uint8_t* buf = nullptr;
+  size_t   bufLen = 0, bufPos = 0;
+  size_t   remaining = 0, sent = 0;
+  uint32_t startMs = 0;
+
+  ~Download() {
+    if (f) f.close();
+    free(buf);
+    if (path.length()) ErrorLogService.logTransfer(path.c_str(), sent, millis() - startMs, remaining == 0);
+  }
+
+  size_t fill(uint8_t* out, size_t maxLen) {
+    size_t n = 0;
+    while (n < maxLen && remaining) {
+      if (bufPos == bufLen) {
+        const size_t want = std::min(LFS_BLOCK - f.position() % LFS_BLOCK, remaining);
+        bufLen = f.read(buf, want);
+        bufPos = 0;
+        if (!bufLen) break;                      // bestand ingekort tijdens transfer
+      }
+      const size_t k = std::min(std::min(maxLen - n, bufLen - bufPos), remaining);
+      memcpy(out + n, buf + bufPos, k);
+      n += k; bufPos += k; remaining -= k; sent += k;
+    }
+    return n;
+  }
+};
+
+// Upload naar "<doel>.part": fragmenten (TCP-grootte) gaan via een RAM-buffer
+// van één blok, zodat LittleFS alleen hele, uitgelijnde blokken programmeert.
+// CRC32 loopt altijd mee, SHA-256 alleen als de client X-Content-SHA256 stuurt.
+// Pas commit() maakt met één rename het doel; een afgebroken of foute upload
+// laat het doel ongemoeid (de destructor ruimt het .part-bestand op).
+struct UploadSink {
+  String      target, tmpPath;
+  File        f;
+  uint8_t*    buf = nullptr;
+  size_t      fill = 0;
+  uint32_t    total = 0;
+  uint32_t    crc = 0;
+  uint32_t    expectCrc = 0;
+  uint8_t     expectSha[32];
+  bool        wantCrc = false, wantSha = false;
+  bool        committed = false;
+  int         status = 0;              // 0 = ok, anders HTTP-status van de fout
+  const char* error = nullptr;
+  uint32_t    startMs = 0;
+  mbedtls_sha256_context sha;
+
+  UploadSink()  { mbedtls_sha256_init(&sha); }
+  ~UploadSink() { if (!committed) discard(); free(buf); mbedtls_sha256_free(&sha); }
+
+  bool fail(int code, const char* err) {
+    if (!status) { status = code; error = err; }
+    discard();
+    return false;
+  }
+
+  static bool parseHex(const String& hex, uint8_t* out, size_t bytes) {
+    if (hex.length() != bytes * 2) return false;
+    for (size_t i=0; i<bytes * 2; ++i) {
+      const char c = hex[i];
+      const int v = (c >= '0' && c <= '9') ? c - '0' : (c >= 'a' && c <= 'f') ? c - 'a' + 10
+                  : (c >= 'A' && c <= 'F') ? c - 'A' + 10 : -1;
+      if (v < 0) return false;
+      if (i & 1) out[i / 2] |= (uint8_t)v; else out[i / 2] = (uint8_t)(v << 4);
+    }
+    return true;
+  }
+
+  bool open(AsyncWebServerRequest* req, const String& path, bool overwrite) {
+    return expect(req) && open(path, overwrite);
+  }
+
+  // Controlewaarden uit X-Content-CRC32 / X-Content-SHA256 (optioneel).
+  bool expect(AsyncWebServerRequest* req) {
+    if (req->hasHeader("X-Content-CRC32")) {
+      uint8_t b[4];
+      if (!parseHex(req->getHeader("X-Content-CRC32")->value(), b, 4)) return fail(400, "bad_crc32_header");
+      expectCrc = ((uint32_t)b[0] << 24) | ((uint32_t)b[1] << 16) | ((uint32_t)b[2] << 8) | b[3];
+      wantCrc = true;
+    }
+    if (req->hasHeader("X-Content-SHA256")) {
+      if (!parseHex(req->getHeader("X-Content-SHA256")->value(), expectSha, 32)) return fail(400, "bad_sha256_header");
+      wantSha = true;
+      mbedtls_sha256_starts_ret(&sha, 0);
+    }
+    return true;
+  }
+
+  bool open(const String& path, bool overwrite) {
+    target  = path;
+    if (path.endsWith("/")) return fail(400, "bad_path");
+    if (!overwrite && LittleFS.exists(path)) return fail(409, "exists");
+    buf = (uint8_t*)malloc(LFS_BLOCK);
+    if (!buf) return fail(503, "out_of_memory");
+    tmpPath = path + ".part";
+    f = LittleFS.open(tmpPath, "w");
+    if (!f) return fail(500, "open_failed");
+    startMs = millis();
+    return true;
+  }
+
+  bool write(const uint8_t* data, size_t len) {
+    if (status || !f) return false;
+    crc = esp_rom_crc32_le(crc, data, len);
+    if (wantSha) mbedtls_sha256_update_ret(&sha, data, len);
+    total += len;
+    while (len) {
+      const size_t take = std::min(len, LFS_BLOCK - fill);
+      memcpy(buf + fill, data, take);
+      fill += take; data += take; len -= take;
+      if (fill == LFS_BLOCK && !flush()) return false;
+    }
+    return true;
+  }
+
+  bool flush() {
+    if (fill && f.write(buf, fill) != fill) return fail(507, "write_failed");   // FS vol
+    fill = 0;
+    return true;
+  }
+
+  // Afsluiten en controleren; het .part-bestand staat dan compleet klaar.
+  bool finish() {
+    if (status || !f) return false;
+    if (!flush()) return false;
+    f.close();
+    free(buf);
+    buf = nullptr;
+    if (wantCrc && crc != expectCrc) return fail(422, "crc32_mismatch");
+    if (wantSha) {
+      uint8_t digest[32];
+      mbedtls_sha256_finish_ret(&sha, digest);
+      if (memcmp(digest, expectSha, sizeof(digest)) != 0) return fail(422, "sha256_mismatch");
+    }
+    return true;
+  }
+
+  // finish(), maar het .part-bestand blijft staan: de aanroeper zet het later
+  // zelf op zijn plaats (of ruimt het op).
+  bool seal() {
+    if (!finish()) return false;
+    committed = true;
+    return true;
+  }
+
+  bool commit() {
+    if (!finish()) return false;
+    if (!replaceFile(tmpPath, target)) return fail(500, "rename_failed");
+    committed = true;
+    FileIndex::update(target);                  // manifest: varianten/ETag opnieuw bepalen
+    ErrorLogService.logTransfer(target.c_str(), total, millis() - startMs, true);
+    return true;
+  }
+
+  void discard() {
+    if (f) f.close();
+    if (tmpPath.length() && LittleFS.exists(tmpPath)) LittleFS.remove(tmpPath);
+  }
+
+  void respond(AsyncWebServerRequest* req) {
+    auto* res = req->beginResponseStream("application/json");
+    JsonWriter j(*res);
+    j.beginObject();
+    if (status) {
+      res->setCode(status);
+      j.field(F("error"), error);
+    } else {
+      char hex[9];
+      snprintf(hex, sizeof(hex), "%08lx", (unsigned long)crc);
+      j.field(F("ok"), true);
+      j.field(F("path"), target);
+      j.field(F("size"), total);
+      j.field(F("crc32"), hex);
+    }
+    j.endObject();
+    req->send(res);
+  }
+};
+
+// POST /fs/unpack: tar-stream (ustar/v7) die per body-chunk wordt ontleed.
+// Elke entry gaat via een UploadSink naar "<doel>.part"; pas als het hele
+// archief binnen en in orde is, worden alle .part-bestanden achter elkaar
+// hernoemd. Dat gebeurt in één async_tcp-callback, dus geen ander HTTP-request
+// ziet een half bijgewerkte site. Bij een fout of afgebroken verbinding
+// verdwijnen alle .part-bestanden; het doel blijft ongemoeid. Mislukt een
+// rename halverwege (of valt de stroom uit), dan blijven de al hernoemde
+// entries staan; de response noemt ze onder "committed".
+struct UnpackSink {
+  static const size_t   BLOCK = 512;
+  static const uint16_t MAX_ENTRIES = 256;
+
+  String   root;
+  bool     overwrite = false;
+  uint8_t  hdr[BLOCK];
+  size_t   hdrFill = 0;
+  std::unique_ptr<UploadSink> cur;   // entry waarvan de inhoud nu binnenkomt
+  size_t   remaining = 0, pad = 0;   // inhoud / padding van de huidige entry
+  bool     skipping = false;         // inhoud van een overgeslagen entry
+  bool     ended = false;            // nulblok gezien
+  std::vector<String> staged;        // doelen waarvan het .part-bestand klaar staat
+  size_t   renamed = 0;              // staged[0..renamed) staat al op zijn plaats
+  uint32_t bytes = 0, skipped = 0, startMs = 0;
+  bool     committed = false;
+  int      status = 0;
+  const char* error = nullptr;
+  String   entry;                    // laatste entry (voor foutmeldingen)
+
+  ~UnpackSink() { if (!committed) discard(); }
+
+  bool fail(int code, const char* err) {
+    if (!status) { status = code; error = err; }
+    cur.reset();
+    discard();
+    return false;
+  }
+
+  void discard() {
+    for (const String& t : staged) LittleFS.remove(t + ".part");
+    staged.clear();
+  }
+
+  static uint32_t octal(const uint8_t* p, size_t n) {
+    uint32_t v = 0;
+    for (size_t i=0; i<n && p[i]; ++i) {
+      if (p[i] == ' ') continue;
+      if (p[i] < '0' || p[i] > '7') break;
+      v = (v << 3) | (p[i] - '0');
+    }
+    return v;
+  }
+
+  bool header() {
+    bool zero = true;
+    for (size_t i=0; i<BLOCK && zero; ++i) zero = hdr[i] == 0;
+    if (zero) { ended = true; return true; }
+
+    uint32_t sum = 0;
+    for (size_t i=0; i<BLOCK; ++i) sum += (i >= 148 && i < 156) ? ' ' : hdr[i];
+    if (sum != octal(hdr + 148, 8)) return fail(400, "bad_checksum");
+
+    char name[256];
+    const char* h = (const char*)hdr;
+    const bool ustar = memcmp(h + 257, "ustar", 5) == 0;
+    if (ustar && h[345]) snprintf(name, sizeof(name), "%.155s/%.100s", h + 345, h);
+    else                 snprintf(name, sizeof(name), "%.100s", h);
+    const char* rel = name;
+    while (rel[0] == '.' && rel[1] == '/') rel += 2;
+    entry = rel;
+
+    const uint32_t size = octal(hdr + 124, 12);
+    remaining = size;
+    pad = (BLOCK - size % BLOCK) % BLOCK;
+    skipping = false;
+
+    const char type = h[156];
+    if (type == 'x' || type == 'L') return fail(400, "unsupported_entry");   // pax/GNU lange namen
+    if (!*rel || !strcmp(rel, ".")) { skipping = true; return true; }
+    const String path = sanitizePath(root == "/" ? "/" + String(rel) : root + "/" + rel);
+
+    if (type == '5') {
+      String dir = path;
+      if (dir.endsWith("/")) dir.remove(dir.length() - 1);
+      if (dir.length() > 1 && !mkdirs(dir + "/") ) return fail(500, "mkdir_failed");
+      skipping = true;                            // dir-entries hebben geen inhoud
+      return true;
+    }
+    if (type != '0' && type != 0) {               // links, devices, 'g'-headers: overslaan
+      Serial.printf("[FS] unpack: skip %s (type %c)\n", rel, type ? type : '?');
+      skipped++;
+      skipping = true;
+      return true;
+    }
+
+    for (size_t i=0; i<staged.size(); ++i)        // zelfde pad nogmaals: laatste wint
+      if (staged[i] == path) { staged.erase(staged.begin() + i); break; }
+    if (staged.size() >= MAX_ENTRIES) return fail(413, "too_many_entries");
+    if (!mkdirs(path)) return fail(500, "mkdir_failed");
+    cur.reset(new UploadSink());
+    if (!cur->open(path, overwrite)) return fail(cur->status, cur->error);
+    if (!remaining) return sealEntry();
+    return true;
+  }
+
+  bool sealEntry() {
+    if (!cur->seal()) return fail(cur->status, cur->error);
+    staged.push_back(cur->target);
+    cur.reset();
+    return true;
+  }
+
+  bool write(const uint8_t* data, size_t len) {
+    bytes += len;
+    while (len && !status && !ended) {
+      if (remaining) {                            // inhoud van de huidige entry
+        const size_t k = std::min(len, remaining);
+        if (!skipping && !cur->write(data, k)) return fail(cur->status, cur->error);
+        data += k; len -= k; remaining -= k;
+        if (!remaining && !skipping && !sealEntry()) return false;
+      } else if (pad) {
+        const size_t k = std::min(len, pad);
+        data += k; len -= k; pad -= k;
+      } else {                                    // (deel van) de volgende header
+        const size_t k = std::min(len, BLOCK - hdrFill);
+        memcpy(hdr + hdrFill, data, k);
+        data += k; len -= k; hdrFill += k;
+        if (hdrFill == BLOCK) { hdrFill = 0; if (!header()) return false; }
+      }
+    }
+    return !status;
+  }
+
+  bool commit() {
+    if (status) return false;
+    if (!ended && (hdrFill || remaining || pad)) return fail(400, "truncated_archive");
+    // Alleen de gewijzigde paden in het manifest bijwerken: een volledige
+    // build() zou hier in de async_tcp-callback alle bestanden openen.
+    for (; renamed < staged.size(); ++renamed) {
+      if (!replaceFile(staged[renamed] + ".part", staged[renamed])) break;
+      FileIndex::update(staged[renamed]);
+    }
+    committed = true;                             // .part-bestanden ruimen we hier zelf op
+    if (renamed < staged.size()) {
+      status = 500; error = "rename_failed";
+      entry  = staged[renamed];
+      for (size_t i = renamed; i < staged.size(); ++i) LittleFS.remove(staged[i] + ".part");
+      Serial.printf("[FS] unpack %s: rename of %s failed after %u of %u files\n", root.c_str(),
+                    entry.c_str(), (unsigned)renamed, (unsigned)staged.size());
+      ErrorLogService.logTransfer(root.c_str(), bytes, millis() - startMs, false);
+      return false;
+    }
+    ErrorLogService.logTransfer(root.c_str(), bytes, millis() - startMs, true);
+    return true;
+  }
+
+  void respond(AsyncWebServerRequest* req) {
+    auto* res = req->beginResponseStream("application/json");
+    JsonWriter j(*res);
+    j.beginObject();
+    if (status) {
+      res->setCode(status);
+      j.field(F("error"), error);
+      if (entry.length()) j.field(F("entry"), entry);
+      if (renamed) {                              // deels doorgevoerd: welke wel
+        j.beginArray(F("committed"));
+        for (size_t i=0; i<renamed; ++i) j.value(staged[i]);
+        j.endArray();
+      }
+    } else {
+      j.field(F("ok"), true);
+      j.field(F("path"), root);
+      j.field(F("files"), (uint32_t)staged.size());
+      j.field(F("skipped"), skipped);
+      j.field(F("bytes"), bytes);
+    }
+    j.endObject();
+    req->send(res);
+  }
+};
+
+// Sink hoort bij het request (_tempObject). Bij een verbroken verbinding
+// ruimt onDisconnect hem op; AsyncWebServer zelf zou alleen free() doen.
+template <class Sink>
+Sink* attachSink(AsyncWebServerRequest* req) {
+  Sink* sink = new Sink();
+  req->_tempObject = sink;
+  req->onDisconnect([req]() {
+    delete reinterpret_cast<Sink*>(req->_tempObject);
+    req->_tempObject = nullptr;
+  });
+  return sink;
+}
+
+template <class Sink>
+void finishSink(AsyncWebServerRequest* req) {
+  Sink* sink = reinterpret_cast<Sink*>(req->_tempObject);
+  sink->respond(req);
+  delete sink;
+  req->_tempObject = nullptr;
+}
+
+// Lazy /fs/list: steeds één stuk JSON (kop, één entry, staart) in een kleine
+// regelbuffer; het volgende openNextFile() pas als de TCP-laag weer ruimte
+// heeft. Geheugen is vast (deze struct), ongeacht de grootte van de map.
+// Cursor = relatieve naam van de laatst geleverde entry. Hervatten loopt per
+// niveau met getNextFileName() naar die naam (readdir, geen File per entry)
+// en daalt af langs het pad; toevoegen/verwijderen van andere entries
+// verschuift een pagina dus niet. Is de cursor-entry zelf weg, dan 409.
+struct DirList {
+  static const uint8_t MAX_DEPTH = 8;
+  enum : uint8_t { F_SIZE = 1, F_DIR = 2, F_ALL = F_SIZE | F_DIR };
+
+  class LineBuf : public Print {
+  public:
+    size_t write(uint8_t c) override { if (len < sizeof(buf)) buf[len++] = (char)c; return 1; }
+    void reset() { len = off = 0; }
+    char   buf[768];                 // ruim voor een ge-escapet pad van MAX_DEPTH niveaus
+    size_t len = 0, off = 0;
+  };
+
+  String   root;
+  size_t   rootLen = 1;              // te strippen prefix van f.path() (incl. '/')
+  File     dirs[MAX_DEPTH];
+  uint8_t  depth = 0;
+  bool     recursive = false;
+  uint8_t  fields = F_ALL;
+  String   after;                    // cursor uit het request ("" = begin)
+  String   last;                     // laatst geleverde entry = next_cursor
+  uint32_t limit = 0, emitted = 0;
+  uint8_t  stage = 0;
+  File     peek;                     // volgende entry (bepaalt of er nog een pagina is)
+  LineBuf  line;
+  JsonWriter j{line};
+
+  // Volgende entry in diepte-eerst volgorde; lege File = klaar.
+  File next() {
+    while (depth) {
+      File f = dirs[depth - 1].openNextFile();
+      if (!f) { dirs[--depth].close(); continue; }
+      if (recursive && f.isDirectory() && depth < MAX_DEPTH) dirs[depth++] = f;
+      return f;
+    }
+    return File();
+  }
+
+  // Positioneer direct na de entry `after` (diepte-eerst, zoals next()).
+  // false = cursor-entry bestaat niet meer.
+  bool seek() {
+    String prefix = root == "/" ? String() : root;
+    int from = 0;
+    while (from <= (int)after.length()) {
+      int slash = after.indexOf('/', from);
+      if (slash < 0) slash = after.length();
+      const String comp = after.substring(from, slash);
+      const bool leaf = slash >= (int)after.length();
+      from = slash + 1;
+      if (!comp.length() || !depth) return false;
+
+      bool found = false;
+      for (String n = dirs[depth - 1].getNextFileName(); n.length(); n = dirs[depth - 1].getNextFileName()) {
+        if (n.substring(n.lastIndexOf('/') + 1) == comp) { found = true; break; }
+      }
+      if (!found) return false;
+      prefix += "/" + comp;
+      if (!leaf && !recursive) return false;
+      if (!leaf || recursive) {                   // next() zou hierin afdalen
+        File d = LittleFS.open(prefix);
+        if (d && d.isDirectory() && depth < MAX_DEPTH) dirs[depth++] = d;
+        else if (!leaf) return false;
+      }
+    }
+    return true;
+  }
+
+  bool step() {
+    line.reset();
+    switch (stage) {
+      case 0:
+        j.beginObject();
+        j.field(F("path"), root);
+        if (after.length()) j.field(F("cursor"), after); else j.fieldNull(F("cursor"));
+        j.beginArray(F("entries"));
+        peek = next();
+        stage = 1;
+        return true;
+      case 1:
+        if (peek && emitted < limit) {
+          const char* full = peek.path();
+          last = strlen(full) >= rootLen ? full + rootLen : peek.name();
+          j.beginObject();
+          j.field(F("name"), last);
+          if (fields & F_SIZE) j.field(F("size"), (uint32_t)peek.size());
+          if (fields & F_DIR)  j.field(F("dir"),  peek.isDirectory());
+          j.endObject();
+          emitted++;
+          peek = next();
+          return true;
+        }
+        j.endArray();
+        if (peek && emitted) j.field(F("next_cursor"), last); else j.fieldNull(F("next_cursor"));
+        j.endObject();
+        stage = 2;
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  size_t read(uint8_t* buf, size_t maxLen) {
+    size_t n = 0;
+    while (n < maxLen) {
+      if (line.off == line.len && !step()) break;
+      const size_t take = std::min(maxLen - n, line.len - line.off);
+      memcpy(buf + n, line.buf + line.off, take);
+      n += take; line.off += take;
+    }
+    return n;
+  }
+};
+
+// /fs/archive: POSIX ustar van een subboom, gegenereerd terwijl de TCP-laag
+// leest. Per entry een header van 512 bytes, dan de inhoud rechtstreeks uit
+// het bestand in de chunk-buffer en nul-padding tot 512; aan het eind twee
+// nulblokken. Geheugen = deze struct (één header + de mapstack), geen
+// tijdelijke bestanden. Namen zijn relatief t.o.v. de gevraagde map.
+struct TarStream {
+  static const uint8_t MAX_DEPTH = 8;
+  static const size_t  BLOCK = 512;
+  enum : uint8_t { S_NEXT, S_HEADER, S_DATA, S_PAD, S_END, S_DONE };
+
+  String   root;
+  size_t   rootLen = 1;
+  File     dirs[MAX_DEPTH];
+  uint8_t  depth = 0;
+  File     cur;                      // bestand waarvan de inhoud nu loopt
+  uint8_t  hdr[BLOCK];
+  size_t   off = 0;                  // positie in hdr / padding / eindblokken
+  size_t   remaining = 0, pad = 0;
+  uint8_t  stage = S_NEXT;
+  uint32_t files = 0, skipped = 0, sent = 0, startMs = 0;
+
+  ~TarStream() {
+    if (cur) cur.close();
+    for (uint8_t i=0; i<depth; ++i) dirs[i].close();
+    if (startMs) {
+      ErrorLogService.logTransfer(root.c_str(), sent, millis() - startMs, stage == S_DONE);
+      Serial.printf("[FS] archive %s: %u files, %u skipped, %u bytes\n", root.c_str(),
+                    (unsigned)files, (unsigned)skipped, (unsigned)sent);
+    }
+  }
+
+  static void octal(char* field, size_t width, uint32_t v) {   // width incl. NUL
+    field[width - 1] = 0;
+    for (size_t i = width - 1; i-- > 0; v >>= 3) field[i] = '0' + (v & 7);
+  }
+
+  // ustar: name (100) en prefix (155) samen; te lange paden worden overgeslagen.
+  bool header(const char* rel, bool dir, uint32_t size, uint32_t mtime) {
+    char name[256];
+    const int n = snprintf(name, sizeof(name), dir ? "%s/" : "%s", rel);
+    if (n <= 0 || n >= (int)sizeof(name)) return false;
+    memset(hdr, 0, BLOCK);
+    char* h = (char*)hdr;
+    if (n <= 100) memcpy(h, name, n);
+    else {
+      const char* split = nullptr;               // laatste '/' waarna de rest in 100 past
+      for (const char* p = name; *p; ++p)
+        if (*p == '/' && p - name <= 155 && name + n - (p + 1) <= 100 && p + 1 < name + n) split = p;
+      if (!split) return false;
+      memcpy(h, split + 1, name + n - (split + 1));
+      memcpy(h + 345, name, split - name);
+    }
+    octal(h + 100, 8, dir ? 0755 : 0644);
+    octal(h + 108, 8, 0);
+    octal(h + 116, 8, 0);
+    octal(h + 124, 12, dir ? 0 : size);
+    octal(h + 136, 12, mtime);
+    memset(h + 148, ' ', 8);
+    h[156] = dir ? '5' : '0';
+    memcpy(h + 257, "ustar", 6);
+    memcpy(h + 263, "00", 2);
+    uint32_t sum = 0;
+    for (size_t i=0; i<BLOCK; ++i) sum += hdr[i];
+    octal(h + 148, 7, sum);                       // 6 cijfers + NUL, spatie blijft staan
+    return true;
+  }
+
+  // Volgende entry (diepte-eerst) en zijn header; false = boom klaar.
+  bool advance() {
+    while (depth) {
+      File f = dirs[depth - 1].openNextFile();
+      if (!f) { dirs[--depth].close(); continue; }
+      const char* full = f.path();
+      const char* rel = strlen(full) >= rootLen ? full + rootLen : f.name();
+      const bool dir = f.isDirectory();
+      const uint32_t size = dir ? 0 : f.size();
+      if (!header(rel, dir, size, (uint32_t)f.getLastWrite())) {
+        Serial.printf("[FS] archive: skip %s (name too long)\n", full);
+        skipped++;
+        continue;
+      }
+      if (dir) {
+        if (depth < MAX_DEPTH) dirs[depth++] = f; else skipped++;
+      } else {
+        cur = f;
+        remaining = size;
+        pad = (BLOCK - size % BLOCK) % BLOCK;
+        files++;
+      }
+      return true;
+    }
+    return false;
+  }
+
+  size_t read(uint8_t* out, size_t maxLen) {
+    size_t n = 0;
+    while (n < maxLen && stage != S_DONE) {
+      switch (stage) {
+        case S_NEXT:
+          off = 0;
+          stage = advance() ? S_HEADER : S_END;
+          break;
+        case S_HEADER: {
+          const size_t k = std::min(maxLen - n, BLOCK - off);
+          memcpy(out + n, hdr + off, k);
+          n += k; off += k;
+          if (off == BLOCK) { off = 0; stage = remaining ? S_DATA : (pad ? S_PAD : S_NEXT); }
+          break;
+        }
+        case S_DATA: {
+          const size_t want = std::min(maxLen - n, remaining);
+          size_t k = cur.read(out + n, want);
+          if (!k) { k = want; memset(out + n, 0, k); }   // ingekort: grootte staat al in de header
+          n += k; remaining -= k;
+          if (!remaining) { cur.close(); stage = pad ? S_PAD : S_NEXT; }
+          break;
+        }
+        case S_PAD: {
+          const size_t k = std::min(maxLen - n, pad);
+          memset(out + n, 0, k);
+          n += k; pad -= k;
+          if (!pad) stage = S_NEXT;
+          break;
+        }
+        case S_END: {                              // twee nulblokken
+          const size_t k = std::min(maxLen - n, 2 * BLOCK - off);
+          memset(out + n, 0, k);
+          n += k; off += k;
+          if (off == 2 * BLOCK) stage = S_DONE;
+          break;
+        }
+      }
+    }
+    sent += n;
+    return n;
+  }
+};
+
+} // namespace
+
 namespace Routes {
 
+static const uint32_t FS_LIST_DEFAULT = 100;   // entries per pagina
+static const uint32_t FS_LIST_MAX     = 1000;
+
+void writeJsonFsInfo(Print& out){
+  JsonWriter j(out);
+  j.beginObject();
+  j.field(F("total"), (uint32_t)LittleFS.totalBytes());
+  j.field(F("used"),  (uint32_t)LittleFS.usedBytes());
+  j.endObject();
+}
+
 void installFS(AsyncWebServer& srv, bool requireAuth){
   // GET /fs/info
   srv.on("/fs/info", HTTP_GET, [requireAuth](AsyncWebServerRequest* req){
     if (!guardAuth(req, requireAuth)) return;
-    size_t total = LittleFS.totalBytes();
-    size_t used  = LittleFS.usedBytes();
-    String json = "{\"total\":" + String(total) + ",\"used\":" + String(used) + "}";
-    Serial.printf("[FS] info total=%u used=%u\n", (unsigned)total, (unsigned)used);
-    sendJson(req, json);
+    TaskMonitor::HeapRouteScope heapScope("fs/info");
+    TRACE_SCOPE("fs/info");
+    auto* res = req->beginResponseStream("application/json");
+    writeJsonFsInfo(*res);
+    res->addHeader("Cache-Control", "no-store");
+    Serial.println(F("[FS] info"));
+    req->send(res);
   });
 
-  // GET /fs/list?path=/dir
+  // GET /fs/list?path=/dir[&cursor=naam][&limit=100][&recursive=1][&fields=size,dir]
+  //   {"path":..,"cursor":..|null,"entries":[{"name":..,"size":..,"dir":..}],"next_cursor":"naam"|null}
+  //   409 cursor_stale: de cursor-entry is verwijderd; opnieuw beginnen.
   srv.on("/fs/list", HTTP_GET, [requireAuth](AsyncWebServerRequest* req){
     if (!guardAuth(req, requireAuth)) return;
+    TaskMonitor::HeapRouteScope heapScope("fs/list");
+    TRACE_SCOPE("fs/list");
     String path = "/";
     if (req->hasParam("path")) path = req->getParam("path")->value();
     path = sanitizePath(path);
 
+    uint32_t limit = FS_LIST_DEFAULT;
+    if (req->hasParam("limit")) {
+      const long v = req->getParam("limit")->value().toInt();
+      limit = v <= 0 ? FS_LIST_DEFAULT : std::min((uint32_t)v, FS_LIST_MAX);
+    }
+    uint8_t fields = DirList::F_ALL;
+    if (req->hasParam("fields")) {
+      const String& list = req->getParam("fields")->value();
+      fields = 0;
+      int from = 0;
+      while (from <= (int)list.length()) {
+        int comma = list.indexOf(',', from);
+        if (comma < 0) comma = list.length();
+        const String f = list.substring(from, comma);
+        from = comma + 1;
+        if (f == "size") fields |= DirList::F_SIZE;
+        else if (f == "dir") fields |= DirList::F_DIR;
+        else if (f.length() && f != "name") {
+          req->send(400, "application/json", "{\"error\":\"unknown_field\"}");
+          return;
+        }
+      }
+    }
+
     if (!LittleFS.exists(path)) { req->send(404, "application/json", "{\"error\":\"not_found\"}"); return; }
 
     File dir = LittleFS.open(path);
     if (!dir || !dir.isDirectory()) { req->send(400, "application/json", "{\"error\":\"not_a_directory\"}"); return; }
 
-    String json = "{\"path\":\"" + jsonEscape(path) + "\",\"entries\":[";
-    bool first = true;
-    File f = dir.openNextFile();
-    while (f) {
-      if (!first) json += ","; first = false;
-      String name = String(f.name());
-      if (name.startsWith(path) && path != "/") name = name.substring(path.length());
-      if (name.startsWith("/")) name.remove(0,1);
-      json += "{\"name\":\"" + jsonEscape(name) + "\",";
-      json += "\"size\":" + String((unsigned)f.size()) + ",";
-      json += "\"dir\":"  + String(f.isDirectory() ? "true" : "false") + "}";
-      f = dir.openNextFile();
-    }
-    json += "]}";
-    Serial.printf("[FS] list %s\n", path.c_str());
-    sendJson(req, json);
+    auto list = std::make_shared<DirList>();
+    list->root      = path;
+    list->rootLen   = path == "/" ? 1 : path.length() + 1;
+    list->dirs[0]   = dir;
+    list->depth     = 1;
+    list->recursive = req->hasParam("recursive") && req->getParam("recursive")->value() != "0";
+    list->fields    = fields;
+    list->after     = req->hasParam("cursor") ? req->getParam("cursor")->value() : String();
+    list->limit     = limit;
+    if (list->after.length() && !list->seek()) {
+      req->send(409, "application/json", "{\"error\":\"cursor_stale\"}");
+      return;
+    }
+
+    AsyncWebServerResponse* res = req->beginChunkedResponse("application/json",
+      [list](uint8_t* buffer, size_t maxLen, size_t) -> size_t {
+        TRACE_SCOPE("fs/list.chunk");
+        return list->read(buffer, maxLen);
+      });
+    res->addHeader("Cache-Control", "no-store");
+    Serial.printf("[FS] list %s cursor=%s limit=%u%s\n", path.c_str(), list->after.c_str(),
+                  (unsigned)limit, list->recursive ? " recursive" : "");
+    req->send(res);
   });
 
-  // GET /fs/download?path=/file
+  // GET /fs/download?path=/file   (Range/If-Range -> 206, hervatbaar)
   srv.on("/fs/download", HTTP_GET, [requireAuth](AsyncWebServerRequest* req){
     if (!guardAuth(req, requireAuth)) return;
+    TaskMonitor::HeapRouteScope heapScope("fs/download");
+    TRACE_SCOPE("fs/download");
     if (!req->hasParam("path")) { req->send(400, "text/plain", "path required"); return; }
     String path = sanitizePath(req->getParam("path")->value());
     if (!LittleFS.exists(path)) { req->send(404, "text/plain", "not found"); return; }
@@ -69,82 +784,217 @@ void installFS(AsyncWebServer& srv, bool requireAuth){
     String fname = path; int slash = fname.lastIndexOf('/');
     if (slash >= 0 && slash < (int)fname.length()-1) fname = fname.substring(slash+1);
 
-    File* f = new File(LittleFS.open(path, "r"));
-    if (!(*f)) { delete f; req->send(404, "text/plain", "not found"); return; }
+    auto dl = std::make_shared<Download>();
+    dl->f = LittleFS.open(path, "r");
+    if (!dl->f || dl->f.isDirectory()) { req->send(404, "text/plain", "not found"); return; }
+    const size_t size = dl->f.size();
 
-    AsyncWebServerResponse* res = req->beginChunkedResponse(
-      "application/octet-stream",
-      [f](uint8_t* buffer, size_t maxLen, size_t)->size_t {
-        if (!(*f)) return 0;
-        size_t n = f->read(buffer, maxLen);
-        if (n == 0) { f->close(); delete f; }
-        return n;
+    // Validator voor If-Range: grootte + mtime (logs groeien buiten de API om).
+    const time_t mtime = dl->f.getLastWrite();
+    const String tag = "\"" + String((unsigned long)size, HEX) + "-" + String((unsigned long)mtime, HEX) + "\"";
+    const String lastMod = FileIndex::httpDate(mtime);
+
+    size_t start = 0, end = size ? size - 1 : 0;
+    RangeResult range = RANGE_NONE;
+    if (req->hasHeader("Range")) {
+      bool fresh = true;
+      if (req->hasHeader("If-Range")) {
+        const String& ir = req->getHeader("If-Range")->value();
+        fresh = ir == tag || (lastMod.length() && ir == lastMod);
+      }
+      if (fresh) range = parseRange(req->getHeader("Range")->value(), size, start, end);
+    }
+    if (range == RANGE_UNSATISFIABLE) {
+      AsyncWebServerResponse* res = req->beginResponse(416, "text/plain", "range not satisfiable");
+      res->addHeader("Content-Range", "bytes */" + String((unsigned)size));
+      res->addHeader("Accept-Ranges", "bytes");
+      req->send(res);
+      return;
+    }
+
+    dl->buf = (uint8_t*)malloc(LFS_BLOCK);
+    if (!dl->buf) { req->send(503, "text/plain", "out of memory"); return; }
+    if (start && !dl->f.seek(start)) { req->send(500, "text/plain", "seek failed"); return; }
+    const size_t len = size ? end - start + 1 : 0;
+    dl->path      = path;
+    dl->remaining = len;
+    dl->startMs   = millis();
+
+    // Content-Length altijd bekend; de lambda houdt de state (en het bestand)
+    // vast tot de response verdwijnt, ook als de client halverwege afhaakt.
+    AsyncWebServerResponse* res = req->beginResponse(
+      "application/octet-stream", len,
+      [dl](uint8_t* buffer, size_t maxLen, size_t) -> size_t {
+        TRACE_SCOPE("fs/download.chunk");
+        return dl->fill(buffer, maxLen);
       }
     );
+    if (range == RANGE_OK) {
+      res->setCode(206);
+      res->addHeader("Content-Range", "bytes " + String((unsigned)start) + "-" + String((unsigned)end) + "/" + String((unsigned)size));
+    }
+    res->addHeader("Accept-Ranges", "bytes");
+    res->addHeader("ETag", tag);
+    if (lastMod.length()) res->addHeader("Last-Modified", lastMod);
     res->addHeader("Content-Disposition", "attachment; filename=\"" + fname + "\"");
     res->addHeader("Cache-Control", "no-store");
-    Serial.printf("[FS] download %s\n", path.c_str());
+    Serial.printf("[FS] download %s %u-%u/%u\n", path.c_str(), (unsigned)start, (unsigned)end, (unsigned)size);
+    req->send(res);
+  });
+
+  // GET /fs/archive?path=/dir   (ustar van de hele subboom, gestreamd)
+  srv.on("/fs/archive", HTTP_GET, [requireAuth](AsyncWebServerRequest* req){
+    if (!guardAuth(req, requireAuth)) return;
+    TaskMonitor::HeapRouteScope heapScope("fs/archive");
+    TRACE_SCOPE("fs/archive");
+    String path = "/";
+    if (req->hasParam("path")) path = req->getParam("path")->value();
+    path = sanitizePath(path);
+
+    if (!LittleFS.exists(path)) { req->send(404, "application/json", "{\"error\":\"not_found\"}"); return; }
+    File dir = LittleFS.open(path);
+    if (!dir || !dir.isDirectory()) { req->send(400, "application/json", "{\"error\":\"not_a_directory\"}"); return; }
+
+    auto tar = std::make_shared<TarStream>();
+    tar->root    = path;
+    tar->rootLen = path == "/" ? 1 : path.length() + 1;
+    tar->dirs[0] = dir;
+    tar->depth   = 1;
+    tar->startMs = millis();
+
+    String fname = path == "/" ? String("littlefs") : path.substring(path.lastIndexOf('/') + 1);
+    AsyncWebServerResponse* res = req->beginChunkedResponse("application/x-tar",
+      [tar](uint8_t* buffer, size_t maxLen, size_t) -> size_t {
+        TRACE_SCOPE("fs/archive.chunk");
+        return tar->read(buffer, maxLen);
+      });
+    res->addHeader("Content-Disposition", "attachment; filename=\"" + fname + ".tar\"");
+    res->addHeader("Cache-Control", "no-store");
+    Serial.printf("[FS] archive %s\n", path.c_str());
     req->send(res);
   });
 
   // POST /fs/upload   (multipart/form-data)
-  // Concurrency-safe: we gebruiken request->_tempObject om per request een File* te bewaren
+  // Optioneel X-Content-CRC32 / X-Content-SHA256 (hex) als controle op de inhoud.
   srv.on("/fs/upload", HTTP_POST,
     // completed
     [requireAuth](AsyncWebServerRequest* req){
       if (!guardAuth(req, requireAuth)) return;
-      if (req->_tempObject) {
-        File* f = reinterpret_cast<File*>(req->_tempObject);
-        if (*f) f->close();
-        delete f;
-        req->_tempObject = nullptr;
-      }
-      req->send(200, "application/json", "{\"ok\":true}");
+      if (!req->_tempObject) { req->send(400, "application/json", "{\"error\":\"no_file\"}"); return; }
+      finishSink<UploadSink>(req);
     },
     // upload handler
     [requireAuth](AsyncWebServerRequest* req, String filename, size_t index, uint8_t *data, size_t len, bool final){
       if (!guardAuth(req, requireAuth)) return;
-      String dir  = req->hasParam("path", true) ? req->getParam("path", true)->value() : "/";
-      String over = req->hasParam("overwrite", true) ? req->getParam("overwrite", true)->value() : "0";
-      dir = sanitizePath(dir);
-      String path = dir;
-      if (!path.endsWith("/")) path += "/";
-      path += filename;
-      path = sanitizePath(path);
-
+      TaskMonitor::HeapRouteScope heapScope("fs/upload");
+      TRACE_SCOPE("fs/upload");
       if (index == 0) {
-        if (over != "1" && LittleFS.exists(path)) {
-          Serial.printf("[FS] upload denied (exists): %s\n", path.c_str());
-          req->send(409, "application/json", "{\"error\":\"exists\"}");
-          return;
-        }
-        File* f = new File(LittleFS.open(path, "w"));
-        if (!(*f)) {
-          delete f;
-          Serial.printf("[FS] upload open failed: %s\n", path.c_str());
-          req->send(500, "application/json", "{\"error\":\"open_failed\"}");
+        // Meerdere bestanden in één form: alleen de status van het laatste telt.
+        UploadSink* prev = reinterpret_cast<UploadSink*>(req->_tempObject);
+        if (prev && prev->status) return;
+        delete prev;
+
+        String dir  = req->hasParam("path", true) ? req->getParam("path", true)->value() : "/";
+        String over = req->hasParam("overwrite", true) ? req->getParam("overwrite", true)->value() : "0";
+        dir = sanitizePath(dir);
+        String path = dir;
+        if (!path.endsWith("/")) path += "/";
+        path += filename;
+        path = sanitizePath(path);
+
+        UploadSink* sink = attachSink<UploadSink>(req);
+        if (!sink->open(req, path, over == "1")) {
+          Serial.printf("[FS] upload %s refused: %s\n", path.c_str(), sink->error);
           return;
         }
-        req->_tempObject = f; // per-request file*
         Serial.printf("[FS] upload start %s\n", path.c_str());
       }
-      if (len && req->_tempObject) {
-        File* f = reinterpret_cast<File*>(req->_tempObject);
-        f->write(data, len);
+      UploadSink* sink = reinterpret_cast<UploadSink*>(req->_tempObject);
+      if (!sink) return;
+      if (len) sink->write(data, len);
+      if (final && sink->commit())
+        Serial.printf("[FS] upload done %s (%u bytes)\n", sink->target.c_str(), (unsigned)sink->total);
+    }
+  );
+
+  // PUT /fs/file?path=/x[&overwrite=1]   (ruwe body, geen multipart; voor scripts)
+  //   curl -T data.bin -H "X-Content-CRC32: $(crc32 data.bin)" "http://esp/fs/file?path=/data.bin&overwrite=1"
+  srv.on("/fs/file", HTTP_PUT,
+    // completed
+    [requireAuth](AsyncWebServerRequest* req){
+      if (!guardAuth(req, requireAuth)) return;
+      if (!req->_tempObject) {                   // lege body: body-handler niet aangeroepen
+        if (!req->hasParam("path")) { req->send(400, "application/json", "{\"error\":\"path_required\"}"); return; }
+        UploadSink* sink = attachSink<UploadSink>(req);
+        const bool over = req->hasParam("overwrite") && req->getParam("overwrite")->value() == "1";
+        if (sink->open(req, sanitizePath(req->getParam("path")->value()), over)) sink->commit();
+      }
+      finishSink<UploadSink>(req);
+    },
+    nullptr,
+    // body handler
+    [requireAuth](AsyncWebServerRequest* req, uint8_t* data, size_t len, size_t index, size_t total){
+      if (!guardAuth(req, requireAuth)) return;
+      TaskMonitor::HeapRouteScope heapScope("fs/file");
+      TRACE_SCOPE("fs/file");
+      if (index == 0) {
+        UploadSink* sink = attachSink<UploadSink>(req);
+        if (!req->hasParam("path")) { sink->fail(400, "path_required"); return; }
+        const String path = sanitizePath(req->getParam("path")->value());
+        const bool over = req->hasParam("overwrite") && req->getParam("overwrite")->value() == "1";
+        if (!sink->open(req, path, over)) {
+          Serial.printf("[FS] put %s refused: %s\n", path.c_str(), sink->error);
+          return;
+        }
+        Serial.printf("[FS] put start %s (%u bytes)\n", path.c_str(), (unsigned)total);
       }
-      if (final && req->_tempObject) {
-        File* f = reinterpret_cast<File*>(req->_tempObject);
-        f->close();
-        delete f;
-        req->_tempObject = nullptr;
-        Serial.printf("[FS] upload done %s (%u bytes)\n", path.c_str(), (unsigned)(index + len));
+      UploadSink* sink = reinterpret_cast<UploadSink*>(req->_tempObject);
+      if (!sink) return;
+      sink->write(data, len);
+      if (index + len >= total && sink->commit())
+        Serial.printf("[FS] put done %s (%u bytes)\n", sink->target.c_str(), (unsigned)sink->total);
+    }
+  );
+
+  // POST /fs/unpack?path=/dir[&overwrite=1]   (ruwe body = tar; alles-of-niets)
+  //   tar -C ui -cf ui.tar . && curl --data-binary @ui.tar -H "Content-Type: application/x-tar" "http://esp/fs/unpack?path=/&overwrite=1"
+  //   Body met bekende lengte: chunked request-bodies (curl -T -) decodeert de server niet.
+  srv.on("/fs/unpack", HTTP_POST,
+    // completed
+    [requireAuth](AsyncWebServerRequest* req){
+      if (!guardAuth(req, requireAuth)) return;
+      if (!req->_tempObject) { req->send(400, "application/json", "{\"error\":\"empty_body\"}"); return; }
+      finishSink<UnpackSink>(req);
+    },
+    nullptr,
+    // body handler
+    [requireAuth](AsyncWebServerRequest* req, uint8_t* data, size_t len, size_t index, size_t total){
+      if (!guardAuth(req, requireAuth)) return;
+      TaskMonitor::HeapRouteScope heapScope("fs/unpack");
+      TRACE_SCOPE("fs/unpack");
+      if (index == 0) {
+        UnpackSink* sink = attachSink<UnpackSink>(req);
+        sink->root      = sanitizePath(req->hasParam("path") ? req->getParam("path")->value() : String("/"));
+        if (sink->root.length() > 1 && sink->root.endsWith("/")) sink->root.remove(sink->root.length() - 1);
+        sink->overwrite = req->hasParam("overwrite") && req->getParam("overwrite")->value() == "1";
+        sink->startMs   = millis();
+        // Grove controle vooraf: tar is nooit kleiner dan zijn inhoud.
+        if (total > LittleFS.totalBytes() - LittleFS.usedBytes()) { sink->fail(507, "insufficient_storage"); return; }
+        Serial.printf("[FS] unpack start %s (%u bytes)\n", sink->root.c_str(), (unsigned)total);
       }
+      UnpackSink* sink = reinterpret_cast<UnpackSink*>(req->_tempObject);
+      if (!sink || sink->status) return;
+      sink->write(data, len);
+      if (index + len >= total && sink->commit())
+        Serial.printf("[FS] unpack done %s (%u files)\n", sink->root.c_str(), (unsigned)sink->staged.size());
     }
   );
 
   // POST /fs/rename  (form fields: from, to)  - overschrijven UIT (409 if to exists)
   srv.on("/fs/rename", HTTP_POST, [requireAuth](AsyncWebServerRequest* req){
     if (!guardAuth(req, requireAuth)) return;
+    TaskMonitor::HeapRouteScope heapScope("fs/rename");
+    TRACE_SCOPE("fs/rename");
     if (!req->hasParam("from", true) || !req->hasParam("to", true)) {
       req->send(400, "application/json", "{\"error\":\"from_to_required\"}");
       return;
@@ -157,6 +1007,13 @@ void installFS(AsyncWebServer& srv, bool requireAuth){
     if (LittleFS.exists(to))    { req->send(409, "application/json", "{\"error\":\"target_exists\"}");   return; }
 
     bool ok = LittleFS.rename(from, to);
+    if (ok) {
+      File moved = LittleFS.open(to, "r");
+      const bool isDir = moved && moved.isDirectory();
+      moved.close();
+      if (isDir) FileIndex::build();             // hele subboom verplaatst
+      else { FileIndex::update(from); FileIndex::update(to); }
+    }
     Serial.printf("[FS] rename %s -> %s  ok=%d\n", from.c_str(), to.c_str(), (int)ok);
     if (!ok) { req->send(500, "application/json", "{\"error\":\"rename_failed\"}"); return; }
     req->send(200, "application/json", "{\"ok\":true}");
@@ -3,4 +3,5 @@
 
 namespace Routes {
   void installFS(AsyncWebServer& srv, bool requireAuth = false);
+  void writeJsonFsInfo(Print& out);   // body van /fs/info: {"total":..,"used":..}
 }
@@ -1,40 +1,56 @@
 #include "RoutesInfo.h"
 #include <WiFi.h>
+#include <TaskMonitor/TaskMonitor.h>
+#include <TaskMonitor/Trace.h>
+#include <Json/JsonWriter.h>
 
 namespace Routes
 {
 
-  void installInfo(AsyncWebServer &srv)
+  void writeJsonNetInfo(Print &out)
   {
-    // /info
-    srv.on("/info", HTTP_GET, [](AsyncWebServerRequest *req)
-           {
     wifi_mode_t mode = WiFi.getMode();
     bool apOn  = mode & WIFI_MODE_AP;
     bool staOn = mode & WIFI_MODE_STA;
     bool staConnected = staOn && (WiFi.status() == WL_CONNECTED);
 
-    String modeStr = staConnected ? (apOn ? "AP+STA" : "STA")
-                                  : (apOn ? "AP" : "OFF");
-
-    String ip   = staConnected ? WiFi.localIP().toString()
-                               : (apOn ? WiFi.softAPIP().toString() : String("0.0.0.0"));
-
-    String ssid = staConnected ? WiFi.SSID()
-                               : (apOn ? WiFi.softAPSSID() : String(""));
+    const char* modeStr = staConnected ? (apOn ? "AP+STA" : "STA")
+                                       : (apOn ? "AP" : "OFF");
 
     int clients = apOn ? WiFi.softAPgetStationNum() : 0;
 
-    String json = "{";
-    json += "\"mode\":\"" + modeStr + "\",";
-    json += "\"ip\":\"" + ip + "\",";
-    json += "\"ssid\":\"" + ssid + "\",";
-    if (staConnected) json += "\"rssi\":" + String(WiFi.RSSI()) + ",";
-    else              json += "\"rssi\":" + String(random(0,100)-70) + ",";
-    json += "\"ap_clients\":" + String(clients);
-    json += "}";
+    JsonWriter j(out);
+    j.beginObject();
+    j.field(F("mode"), modeStr);
+    if (staConnected)  j.field(F("ip"), WiFi.localIP());
+    else if (apOn)     j.field(F("ip"), WiFi.softAPIP());
+    else               j.field(F("ip"), "0.0.0.0");
+    // SSID komt als String uit de WiFi-API; de enige allocatie hier.
+    if (staConnected)  j.field(F("ssid"), WiFi.SSID());
+    else if (apOn)     j.field(F("ssid"), WiFi.softAPSSID());
+    else               j.field(F("ssid"), "");
+    if (staConnected) j.field(F("rssi"), (int32_t)WiFi.RSSI());
+    else              j.field(F("rssi"), (int32_t)(random(0,100)-70));
+    j.field(F("ap_clients"), clients);
+    j.endObject();
+  }
 
-    req->send(200, "application/json", json); });
+  void writeJsonHealth(Print &out)
+  {
+    JsonWriter j(out);
+    j.beginObject().field(F("status"), "ok").endObject();
+  }
+
+  void installInfo(AsyncWebServer &srv)
+  {
+    // /info
+    srv.on("/info", HTTP_GET, [](AsyncWebServerRequest *req)
+           {
+    TaskMonitor::HeapRouteScope heapScope("info");
+    TRACE_SCOPE("info");
+    auto* res = req->beginResponseStream("application/json");
+    writeJsonNetInfo(*res);
+    req->send(res); });
 
     // /health
     srv.on("/health", HTTP_GET, [](AsyncWebServerRequest *req)
@@ -3,4 +3,6 @@
 
 namespace Routes {
   void installInfo(AsyncWebServer& srv); // /info, /health
+  void writeJsonNetInfo(Print& out);     // body van /info
+  void writeJsonHealth(Print& out);      // body van /health
 }
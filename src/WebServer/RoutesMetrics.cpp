@@ -0,0 +1,229 @@
+#include "RoutesMetrics.h"
+#include <LittleFS.h>
+#include <esp_heap_caps.h>
+#include <TaskMonitor/TaskMonitor.h>
+#include <Wifihandler/Wifihandler.h>
+#include <DHT11/DHT11.h>
+#include <Soil/Soil.h>
+#include <TaskMonitor/Trace.h>
+#include <Json/JsonWriter.h>
+#include <esp_timer.h>
+
+// /metrics in OpenMetrics tekstformaat voor Prometheus-scrapes. Alles wordt
+// met print() direct in de response-stream geschreven: geen String's of
+// printf-buffers per scrape; de enige allocaties zijn de response zelf en
+// zijn vooraf gedimensioneerde buffer.
+//
+// Dezelfde middleware meet per route de handler-tijd (histogram), status-
+// klassen en bytes, voor /sys/http, en zet een Server-Timing header zodat
+// devtools apparaat-tijd los van netwerktijd tonen.
+
+namespace Routes {
+
+namespace {
+  // Verzoeken per statusklasse (1xx..5xx); alleen async_tcp schrijft.
+  volatile uint32_t s_httpByClass[5] = {0, 0, 0, 0, 0};
+
+  const size_t METRICS_BUF = 2048;   // ruim boven een typische scrape (~1.5 KB)
+
+  // Per-route statistiek. Statische bestanden delen één entry ("static"),
+  // zodat willekeurige URL's de tabel niet vullen; loopt hij toch vol, dan
+  // telt de rest onder "other".
+  const uint8_t ROUTES = 24;
+  const uint8_t LAT_BUCKETS = 10;
+  const uint32_t LAT_BOUNDS_US[LAT_BUCKETS - 1] = {    // laatste bucket = +Inf
+    1000, 2000, 5000, 10000, 20000, 50000, 100000, 250000, 1000000
+  };
+
+  struct RouteStat {
+    char     path[24];
+    uint32_t count;
+    uint32_t byClass[5];
+    uint64_t bytes;          // Content-Length van de response, indien bekend
+    uint32_t unsized;        // chunked responses: lengte pas bekend tijdens het zenden
+    uint64_t totalUs;
+    uint32_t maxUs;
+    uint32_t hist[LAT_BUCKETS];
+  };
+  RouteStat s_routes[ROUTES];
+  uint8_t   s_routeCount = 0;
+
+  bool isApi(const String& url) {
+    return url.startsWith("/sys/") || url.startsWith("/fs/") || url == "/info" ||
+           url == "/health" || url == "/metrics" || url == "/batch" || url == "/events";
+  }
+
+  RouteStat& routeFor(const String& url) {
+    const char* key = isApi(url) && url.length() < sizeof(RouteStat::path) ? url.c_str() : "static";
+    for (uint8_t i=0; i<s_routeCount; ++i) if (!strcmp(s_routes[i].path, key)) return s_routes[i];
+    if (s_routeCount >= ROUTES - 1) key = "other";       // laatste plek is gereserveerd
+    for (uint8_t i=0; i<s_routeCount; ++i) if (!strcmp(s_routes[i].path, key)) return s_routes[i];
+    RouteStat& r = s_routes[s_routeCount++];
+    memset(&r, 0, sizeof(r));
+    strlcpy(r.path, key, sizeof(r.path));
+    return r;
+  }
+
+  void record(const String& url, int code, size_t len, uint32_t us) {
+    RouteStat& r = routeFor(url);
+    r.count++;
+    if (code >= 100 && code < 600) r.byClass[code / 100 - 1]++;
+    if (len) r.bytes += len; else r.unsized++;
+    r.totalUs += us;
+    if (us > r.maxUs) r.maxUs = us;
+    uint8_t b = 0;
+    while (b < LAT_BUCKETS - 1 && us > LAT_BOUNDS_US[b]) ++b;
+    r.hist[b]++;
+  }
+
+  void family(Print& out, const __FlashStringHelper* name, const __FlashStringHelper* type,
+              const __FlashStringHelper* help) {
+    out.print(F("# TYPE ")); out.print(name); out.print(' '); out.println(type);
+    out.print(F("# HELP ")); out.print(name); out.print(' '); out.println(help);
+  }
+
+  void sample(Print& out, const __FlashStringHelper* name, uint32_t v) {
+    out.print(name); out.print(' '); out.println(v);
+  }
+
+  void sample(Print& out, const __FlashStringHelper* name, int32_t v) {
+    out.print(name); out.print(' '); out.println(v);
+  }
+
+  void sample(Print& out, const __FlashStringHelper* name, float v, uint8_t digits) {
+    if (isnan(v)) return;                       // geen meting => geen sample
+    out.print(name); out.print(' '); out.println(v, digits);
+  }
+
+  void writeMetrics(Print& out) {
+    TRACE_SCOPE("metrics");
+    family(out, F("esp_uptime_seconds"), F("gauge"), F("Seconds since boot."));
+    sample(out, F("esp_uptime_seconds"), (uint32_t)(millis() / 1000UL));
+
+    family(out, F("esp_heap_free_bytes"), F("gauge"), F("Free 8-bit heap."));
+    sample(out, F("esp_heap_free_bytes"), (uint32_t)heap_caps_get_free_size(MALLOC_CAP_8BIT));
+    family(out, F("esp_heap_min_free_bytes"), F("gauge"), F("Lowest free 8-bit heap since boot."));
+    sample(out, F("esp_heap_min_free_bytes"), (uint32_t)heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT));
+    family(out, F("esp_heap_largest_free_block_bytes"), F("gauge"), F("Largest allocatable 8-bit block."));
+    sample(out, F("esp_heap_largest_free_block_bytes"), (uint32_t)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
+
+    float l0 = 0.f, l1 = 0.f;
+    TaskMonitor::getCpuLoadCached(l0, l1);
+    family(out, F("esp_cpu_load_percent"), F("gauge"), F("CPU load per core over the last window."));
+    if (!isnan(l0)) { out.print(F("esp_cpu_load_percent{core=\"0\"} ")); out.println(l0, 1); }
+    if (!isnan(l1)) { out.print(F("esp_cpu_load_percent{core=\"1\"} ")); out.println(l1, 1); }
+
+    const bool staUp = WiFiService.isConnected();
+    family(out, F("esp_wifi_connected"), F("gauge"), F("1 if the STA link is up."));
+    sample(out, F("esp_wifi_connected"), (uint32_t)(staUp ? 1 : 0));
+    family(out, F("esp_wifi_rssi_dbm"), F("gauge"), F("STA signal strength."));
+    if (staUp) sample(out, F("esp_wifi_rssi_dbm"), (int32_t)WiFiService.rssi());
+    family(out, F("esp_wifi_disconnects"), F("counter"), F("STA link losses since boot."));
+    sample(out, F("esp_wifi_disconnects_total"), WiFiService.disconnects());
+    family(out, F("esp_wifi_reconnect_attempts"), F("counter"), F("STA reconnect attempts since boot."));
+    sample(out, F("esp_wifi_reconnect_attempts_total"), WiFiService.reconnectAttempts());
+
+    family(out, F("esp_fs_total_bytes"), F("gauge"), F("LittleFS capacity."));
+    sample(out, F("esp_fs_total_bytes"), (uint32_t)LittleFS.totalBytes());
+    family(out, F("esp_fs_used_bytes"), F("gauge"), F("LittleFS bytes in use."));
+    sample(out, F("esp_fs_used_bytes"), (uint32_t)LittleFS.usedBytes());
+
+    family(out, F("dht_temperature_celsius"), F("gauge"), F("Last valid DHT temperature."));
+    sample(out, F("dht_temperature_celsius"), DHTService.temperature(), 1);
+    family(out, F("dht_humidity_percent"), F("gauge"), F("Last valid DHT relative humidity."));
+    sample(out, F("dht_humidity_percent"), DHTService.humidity(), 1);
+    family(out, F("dht_reads"), F("counter"), F("DHT read attempts since boot."));
+    sample(out, F("dht_reads_total"), DHTService.reads());
+    family(out, F("dht_read_errors"), F("counter"), F("Failed DHT reads since boot."));
+    sample(out, F("dht_read_errors_total"), DHTService.errors());
+
+    if (SoilService.reads()) {
+      family(out, F("soil_adc_raw"), F("gauge"), F("Last soil sensor ADC reading."));
+      sample(out, F("soil_adc_raw"), (int32_t)SoilService.raw());
+      family(out, F("soil_moisture_percent"), F("gauge"), F("Calibrated soil moisture."));
+      sample(out, F("soil_moisture_percent"), (int32_t)SoilService.percent());
+    }
+
+    family(out, F("http_requests"), F("counter"), F("HTTP requests by status class."));
+    for (uint8_t c=0; c<5; ++c) {
+      out.print(F("http_requests_total{code=\""));
+      out.print((char)('1' + c)); out.print(F("xx\"} "));
+      out.println(s_httpByClass[c]);
+    }
+
+    out.println(F("# EOF"));
+  }
+}
+
+void writeJsonHttpStats(Print& out) {
+  JsonWriter j(out);
+  j.beginObject();
+  j.beginArray(F("bounds_ms"));
+  for (uint8_t b=0; b<LAT_BUCKETS - 1; ++b) j.value(LAT_BOUNDS_US[b] / 1000);
+  j.endArray();
+  j.beginArray(F("routes"));
+  for (uint8_t i=0; i<s_routeCount; ++i) {
+    const RouteStat& r = s_routes[i];
+    j.beginObject();
+    j.field(F("path"), (const char*)r.path);
+    j.field(F("count"), r.count);
+    j.beginObject(F("status"));
+    for (uint8_t c=0; c<5; ++c) {
+      if (!r.byClass[c]) continue;
+      const char cls[4] = { (char)('1' + c), 'x', 'x', 0 };
+      j.field(cls, r.byClass[c]);
+    }
+    j.endObject();
+    j.field(F("bytes"), r.bytes);
+    j.field(F("unsized"), r.unsized);
+    j.field(F("avg_ms"), r.count ? (float)(r.totalUs / r.count) / 1000.f : 0.f, 2);
+    j.field(F("max_ms"), r.maxUs / 1000.f, 2);
+    j.beginArray(F("hist"));
+    for (uint8_t b=0; b<LAT_BUCKETS; ++b) j.value(r.hist[b]);
+    j.endArray();
+    j.endObject();
+  }
+  j.endArray();
+  j.endObject();
+}
+
+void installMetrics(AsyncWebServer& srv){
+  // Buitenste middleware: meet de handler (incl. admission) en telt ieder
+  // afgehandeld verzoek. De response is na next() nog niet verzonden, dus
+  // de Server-Timing header kan er nog bij. Chunked responses worden pas
+  // daarna gevuld: hun tijd is alleen de opbouw, niet het zenden.
+  srv.addMiddleware([](AsyncWebServerRequest* req, ArMiddlewareNext next){
+    const int64_t t0 = esp_timer_get_time();
+    next();
+    const uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+    AsyncWebServerResponse* res = req->getResponse();
+    const int code = res ? res->code() : 0;
+    if (code >= 100 && code < 600) s_httpByClass[code / 100 - 1]++;
+    record(req->url(), code, res ? res->getContentLength() : 0, us);
+    if (res) {
+      char st[32];
+      snprintf(st, sizeof(st), "app;dur=%.2f", us / 1000.f);
+      res->addHeader("Server-Timing", st);
+    }
+  });
+
+  // GET /sys/http[?reset=1]  (per-route tellers en latency-histogram)
+  srv.on("/sys/http", HTTP_GET, [](AsyncWebServerRequest* req){
+    auto* res = req->beginResponseStream("application/json", 2048);
+    writeJsonHttpStats(*res);
+    res->addHeader("Cache-Control", "no-store");
+    req->send(res);
+    if (req->hasParam("reset")) s_routeCount = 0;
+  });
+
+  // GET /metrics
+  srv.on("/metrics", HTTP_GET, [](AsyncWebServerRequest* req){
+    auto* res = req->beginResponseStream("application/openmetrics-text; version=1.0.0; charset=utf-8",
+                                         METRICS_BUF);
+    writeMetrics(*res);
+    res->addHeader("Cache-Control", "no-store");
+    req->send(res);
+  });
+}
+
+} // namespace Routes
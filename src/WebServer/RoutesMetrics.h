@@ -0,0 +1,10 @@
+#pragma once
+#include <ESPAsyncWebServer.h>
+
+namespace Routes {
+  void installMetrics(AsyncWebServer& srv); // /metrics (OpenMetrics), /sys/http + HTTP request counters
+
+  // Per-route tellers: {"bounds_ms":[..],"routes":[{"path","count","status":{"2xx":..},
+  // "bytes","unsized","avg_ms","max_ms","hist":[..]}]}
+  void writeJsonHttpStats(Print& out);
+}
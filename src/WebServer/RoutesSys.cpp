@@ -1,8 +1,25 @@
 #include "RoutesSys.h"
 #include <TaskMonitor/TaskMonitor.h>
+#include <TaskMonitor/Trace.h>
+#include <memory>
+#include <algorithm>
 
 namespace Routes {
 
+namespace {
+  // Houdt de profiler-meting vast zolang de response leeft; ook een
+  // afgebroken download geeft hem zo vrij.
+  // Eigenaar van één meting; alleen in place bouwen (een kopie zou bij
+  // zijn destructor de lopende meting vrijgeven).
+  struct ProfileOwner {
+    explicit ProfileOwner(uint32_t i) : id(i) {}
+    ProfileOwner(const ProfileOwner&) = delete;
+    ProfileOwner& operator=(const ProfileOwner&) = delete;
+    ~ProfileOwner() { TaskMonitor::profileRelease(id); }
+    const uint32_t id;
+  };
+}
+
 void installSys(AsyncWebServer& srv){
   // GET /sys/info
   srv.on("/sys/info", HTTP_GET, [](AsyncWebServerRequest* req){
@@ -11,14 +28,101 @@ void installSys(AsyncWebServer& srv){
     req->send(res);
   });
 
-  // GET /sys/active[?window=500&step=1&top=12]
+  // GET /sys/tasks  (exacte CPU per task uit run-time stats)
+  srv.on("/sys/tasks", HTTP_GET, [](AsyncWebServerRequest* req){
+    auto* res = req->beginResponseStream("application/json");
+    TaskMonitor::writeJsonTasks(*res);
+    req->send(res);
+  });
+
+  // GET /sys/active[?top=12]  (laatste snapshot van de achtergrond-sampler)
   srv.on("/sys/active", HTTP_GET, [](AsyncWebServerRequest* req){
-    uint32_t window = 500, step = 1; uint8_t top = 12;
-    if (req->hasParam("window")) window = req->getParam("window")->value().toInt();
-    if (req->hasParam("step"))   step   = req->getParam("step")->value().toInt();
-    if (req->hasParam("top"))    top    = req->getParam("top")->value().toInt();
+    uint8_t top = 12;
+    if (req->hasParam("top")) top = req->getParam("top")->value().toInt();
+    auto* res = req->beginResponseStream("application/json");
+    TaskMonitor::writeJsonActive(*res, top);
+    req->send(res);
+  });
+
+  // GET /sys/heap[?trace=start|stop]
+  srv.on("/sys/heap", HTTP_GET, [](AsyncWebServerRequest* req){
+    if (req->hasParam("trace")) TaskMonitor::heapTrace(req->getParam("trace")->value() == "start");
+    auto* res = req->beginResponseStream("application/json");
+    TaskMonitor::writeJsonHeap(*res);
+    res->addHeader("Cache-Control", "no-store");
+    req->send(res);
+  });
+
+  // GET /sys/stacks
+  srv.on("/sys/stacks", HTTP_GET, [](AsyncWebServerRequest* req){
     auto* res = req->beginResponseStream("application/json");
-    TaskMonitor::writeJsonActive(*res, window, step, top);
+    TaskMonitor::writeJsonStacks(*res);
+    res->addHeader("Cache-Control", "no-store");
+    req->send(res);
+  });
+
+  // GET /sys/loop[?reset=1]
+  srv.on("/sys/loop", HTTP_GET, [](AsyncWebServerRequest* req){
+    auto* res = req->beginResponseStream("application/json");
+    TaskMonitor::writeJsonLoop(*res);
+    res->addHeader("Cache-Control", "no-store");
+    req->send(res);
+    if (req->hasParam("reset")) TaskMonitor::resetLoopStats();
+  });
+
+  // GET /sys/trace[?enable=0|1][&clear=1]  (Chrome Trace Event JSON, laadt in Perfetto)
+  srv.on("/sys/trace", HTTP_GET, [](AsyncWebServerRequest* req){
+    if (!TaskMonitor::traceAvailable()) {
+      req->send(501, "application/json", "{\"error\":\"trace_disabled\",\"hint\":\"build with -DTASKMONITOR_TRACE\"}");
+      return;
+    }
+    if (req->hasParam("enable")) TaskMonitor::traceEnable(req->getParam("enable")->value() != "0");
+    auto exp = std::make_shared<TaskMonitor::TraceExport>();
+    if (req->hasParam("clear")) TaskMonitor::traceClear();   // export heeft al een kopie
+    AsyncWebServerResponse* res = req->beginChunkedResponse("application/json",
+      [exp](uint8_t* buffer, size_t maxLen, size_t /*index*/) -> size_t {
+        return exp->read(buffer, maxLen);
+      });
+    res->addHeader("Cache-Control", "no-store");
+    res->addHeader("Content-Disposition", "attachment; filename=\"trace.json\"");
+    req->send(res);
+  });
+
+  // GET /sys/profile?ms=2000  (PC-histogram; response start pas na de meting)
+  srv.on("/sys/profile", HTTP_GET, [](AsyncWebServerRequest* req){
+    uint32_t ms = 2000;
+    if (req->hasParam("ms")) ms = req->getParam("ms")->value().toInt();
+    ms = std::min<uint32_t>(std::max<uint32_t>(ms, 100), 10000);
+    const uint32_t id = TaskMonitor::profileStart(ms);
+    if (!id) {
+      req->send(409, "application/json", "{\"error\":\"profile_busy_or_unavailable\"}");
+      return;
+    }
+    auto owner = std::make_shared<ProfileOwner>(id);
+    AsyncWebServerResponse* res = req->beginChunkedResponse("text/plain",
+      [owner](uint8_t* buffer, size_t maxLen, size_t /*index*/) -> size_t {
+        if (!TaskMonitor::profileReady()) return RESPONSE_TRY_AGAIN;
+        return TaskMonitor::profileRead(buffer, maxLen);
+      });
+    res->addHeader("Cache-Control", "no-store");
+    res->addHeader("Content-Disposition", "attachment; filename=\"profile.txt\"");
+    req->send(res);
+  });
+
+  // GET /sys/history?metric=heap_free&tier=1s[&format=bin]
+  srv.on("/sys/history", HTTP_GET, [](AsyncWebServerRequest* req){
+    String metric = "heap_free", tier = "1s";
+    if (req->hasParam("metric")) metric = req->getParam("metric")->value();
+    if (req->hasParam("tier"))   tier   = req->getParam("tier")->value();
+    const bool bin = req->hasParam("format") && req->getParam("format")->value() == "bin";
+
+    auto* res = req->beginResponseStream(bin ? "application/octet-stream" : "application/json");
+    if (!TaskMonitor::writeHistory(*res, metric.c_str(), tier.c_str(), bin)) {
+      delete res;
+      req->send(400, "application/json", "{\"error\":\"unknown_metric_or_tier\"}");
+      return;
+    }
+    res->addHeader("Cache-Control", "no-store");
     req->send(res);
   });
 }
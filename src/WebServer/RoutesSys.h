@@ -2,5 +2,5 @@
 #include <ESPAsyncWebServer.h>
 
 namespace Routes {
-  void installSys(AsyncWebServer& srv); // /sys/info, /sys/active
+  void installSys(AsyncWebServer& srv); // /sys/info, /sys/tasks, /sys/active, /sys/heap, /sys/stacks, /sys/loop, /sys/trace, /sys/profile, /sys/history
 }
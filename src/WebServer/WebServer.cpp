@@ -1,10 +1,17 @@
 #include "WebServer.h"
 #include <LittleFS.h>
+#include <TaskMonitor/TaskMonitor.h>
+#include "AssetCache.h"
+#include "FileIndex.h"
+#include "AssetPack.h"
 
 #include "RoutesCore.h"
 #include "RoutesInfo.h"
 #include "RoutesFS.h"
 #include "RoutesSys.h"
+#include "RoutesMetrics.h"
+#include "RoutesEvents.h"
+#include "RoutesBatch.h"
 
 WebServerHandler WebServerService;
 
@@ -25,6 +32,13 @@ bool WebServerHandler::begin(const Options& opts) {
     return false;
   }
 
+  AssetPack::begin();                          // optionele read-only asset-partitie
+  FileIndex::build();                          // manifest voor routing/ETags
+  AssetCache::configure(opts.assetCacheBytes, opts.assetCacheMaxFile);
+  TaskMonitor::addInfoSection("asset_cache", AssetCache::writeJson);   // in /sys/info
+  Admission::configure(opts.admission);
+  TaskMonitor::addInfoSection("admission", Admission::writeJson);
+
   _installRoutes();
   _server->begin();
   Serial.printf("[Web] Server started on port %u\n", _serverPort);
@@ -36,13 +50,23 @@ void WebServerHandler::stop() {
   _server->end();
   delete _server;
   _server = nullptr;
+  AssetCache::clear();
   Serial.println(F("[Web] Server stopped"));
 }
 
+void WebServerHandler::loop() {
+  if (!_server) return;                       // event source verdwijnt met de server
+  Routes::eventsLoop(_opts.eventsIntervalMs);
+}
+
 void WebServerHandler::_installRoutes() {
   using namespace Routes;
   installCore(*_server);                      // favicon, root, onNotFound, assets
   installInfo(*_server);                      // /info, /health
   if (_opts.enableFsApi) installFS(*_server, _opts.fsApiAuth); // /fs/*
-  installSys(*_server);                       // /sys/info, /sys/active
+  installSys(*_server);                       // /sys/info, /sys/tasks, /sys/active, /sys/heap, /sys/stacks, /sys/loop, /sys/trace, /sys/profile, /sys/history
+  installMetrics(*_server);                   // /metrics, /sys/http + HTTP request counters
+  Admission::install(*_server);               // na metrics: 503's worden ook geteld
+  installEvents(*_server);                    // /events (SSE telemetrie)
+  installBatch(*_server, _opts.enableFsApi, _opts.fsApiAuth); // /batch?r=info,sys,...
 }
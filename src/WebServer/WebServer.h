@@ -1,6 +1,7 @@
 #pragma once
 #include <Arduino.h>
 #include <ESPAsyncWebServer.h>
+#include "Admission.h"
 
 class WebServerHandler {
 public:
@@ -8,6 +9,10 @@ struct Options {
   uint16_t port;
   bool enableFsApi;
   bool fsApiAuth;
+  size_t assetCacheBytes;     // RAM-budget voor de static asset cache (0 = uit)
+  size_t assetCacheMaxFile;   // grotere bestanden worden altijd gestreamd
+  uint32_t eventsIntervalMs;  // telemetrie-frame op /events
+  Admission::Limits admission; // gelijktijdigheid, rate limit, heap-drempels
 
   Options()
   : port(80)
@@ -17,12 +22,16 @@ struct Options {
 #else
   , fsApiAuth(false)
 #endif
+  , assetCacheBytes(32 * 1024)
+  , assetCacheMaxFile(8 * 1024)
+  , eventsIntervalMs(3000)
   {}
 };
 
 
   bool begin(const Options& opts = Options{}); // start server
   void stop();                                  // stop server
+  void loop();                                  // in loop(): /events frames versturen
 
   bool isRunning() const { return _server != nullptr; }
   uint16_t port()  const { return _serverPort; }
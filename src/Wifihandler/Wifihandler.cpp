@@ -1,4 +1,5 @@
 #include "WiFiHandler.h"
+#include <TaskMonitor/Trace.h>
 
 #ifdef USE_WIFI_MANAGER
   #include <WiFiManager.h>
@@ -210,12 +211,14 @@ void WiFiHandler::_startSTA(const char* ssid, const char* pass, bool useWiFiMana
 }
 
 void WiFiHandler::_connectIfNeededSTA() {
+  TRACE_SCOPE("wifi.connect");
   if (WiFi.status() == WL_CONNECTED) {
     _connected = true;
     _forceReconnectFlag = false;
     _backoffMs = _minBackoffMs;
     return;
   }
+  _reconnectAttempts++;
   if (_forceReconnectFlag) {
     Serial.println(F("[WiFi] Forcing reconnect..."));
     _startSTA(_staSsid.length() ? _staSsid.c_str() : nullptr,
@@ -231,6 +234,7 @@ void WiFiHandler::_connectIfNeededSTA() {
 }
 
 void WiFiHandler::_onGotIP(WiFiEvent_t, WiFiEventInfo_t) {
+  TRACE_SCOPE("wifi.got_ip");
   const bool prev = _connected;
   _connected = true;
   _forceReconnectFlag = false;
@@ -246,8 +250,10 @@ void WiFiHandler::_onGotIP(WiFiEvent_t, WiFiEventInfo_t) {
 }
 
 void WiFiHandler::_onDisconnected(WiFiEvent_t, WiFiEventInfo_t info) {
+  TRACE_SCOPE("wifi.disconnected");
   const bool prev = _connected;
   _connected = false;
+  if (prev) _disconnects++;
   Serial.printf("[WiFi] STA disconnected (reason=%u). Backoff=%lu ms.\n",
                 info.wifi_sta_disconnected.reason, (unsigned long)_backoffMs);
   if (_onChange && prev != _connected) _onChange(_connected);
@@ -34,6 +34,10 @@ public:
   String currentSSID() const;        // STA SSID
   int32_t rssi() const;              // STA RSSI (in AP-only returns 0)
 
+  // Counters since boot (for /metrics)
+  uint32_t disconnects() const { return _disconnects; }             // STA link lost
+  uint32_t reconnectAttempts() const { return _reconnectAttempts; } // STA (re)connect tries
+
   // Change mode at runtime (optional). If forceRestart=true, will stop/restart WiFi.
   void setMode(WiFiModeSel mode, bool forceRestart = true);
 
@@ -91,6 +95,10 @@ private:
   const uint32_t _minBackoffMs = 1000;
   const uint32_t _maxBackoffMs = 30000;
 
+  // Counters
+  volatile uint32_t _disconnects = 0;
+  volatile uint32_t _reconnectAttempts = 0;
+
   // STA static IP
   bool _useStaticIP = false;
   IPAddress _ip, _gw, _sn, _dns1, _dns2;
@@ -7,14 +7,17 @@
 #include <Faulthandler/ErrorLogger.h>
 #include <Time/TimeService.h>
 #include <DHT11/DHT11.h>
+#include <Soil/Soil.h>
 
 #define DHT11_PIN 22  // GPIO22 DHT11 data pin
+#define SOIL_PIN  32  // GPIO32 (ADC1) bodemvochtsensor
 
 void setup()
 {
   Serial.begin(115200);
   DHTService.begin(DHT11_PIN, DHTesp::DHT11);
-  TaskMonitor::begin(500);  // 500 ms venster + autocalibratie
+  SoilService.begin(SOIL_PIN, /*rawDry=*/3500, /*rawWet=*/1200);
+  TaskMonitor::begin(500);  // 500 ms meetvenster (run-time stats)
   TaskMonitor::printOnce(); // eerste snapshot
   WiFiService.begin("mijn-esp32",
                     WiFiModeSel::STA,
@@ -42,6 +45,14 @@ void setup()
     ErrorLogService.breadcrumb("wifi_down");
   } });
 
+  // Task met (bijna) te kleine stack: breadcrumb (overleeft een crash) + [TASK]-regel
+  TaskMonitor::onStackLow([](const char* task, uint32_t headroom)
+                          {
+  char tag[16];
+  snprintf(tag, sizeof(tag), "stk:%s", task);
+  ErrorLogService.breadcrumb(tag);
+  ErrorLogService.logTaskWatermark(task, headroom, "low"); }, 512);
+
   DHTService.read();
 
   for (int pin : {32, 33, 34, 35, 36, 39}) {
@@ -51,21 +62,16 @@ void setup()
 
 }
 
-void readSoil() {
-  int raw = analogRead(32);
-  int pct = map(raw, 3500, 1200, 0, 100); // kalibreer zelf!
-  pct = constrain(pct, 0, 100);
-  Serial.println("Soil: " + String(raw) + " (" + String(pct) + "%)");
-}
-
 void loop()
 {
-  readSoil();
+  TaskMonitor::LoopScope iteration("loop"); // hele iteratie (incl. delay) => periode/jitter
+  { TaskMonitor::LoopScope t("soil"); SoilService.read(); }
   delay(500);
-  WiFiService.loop();
-  OTAService.loop();
-  ErrorLogService.loop(); // bewaart uptime periodiek in RTC
-  // TaskMonitor::loop(10000); // elke 10s een statusregel
+  { TaskMonitor::LoopScope t("wifi"); WiFiService.loop(); }
+  { TaskMonitor::LoopScope t("ota");  OTAService.loop(); }
+  { TaskMonitor::LoopScope t("web");  WebServerService.loop(); }  // /events telemetrie
+  { TaskMonitor::LoopScope t("errlog"); ErrorLogService.loop(); } // bewaart uptime periodiek in RTC
+  TaskMonitor::loop();   // stack-meldingen afleveren; loop(10000) = ook elke 10s een statusregel
 
 
 